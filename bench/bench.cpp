@@ -0,0 +1,289 @@
+/*
+Benchmarks for the hot paths of the engine: shuffling, dealing, scoring (one hand at a time and
+32 at a time with each batch evaluator the processor supports), strategy lookup and whole
+simulated rounds. Every benchmark prints one tab separated line with a fixed set of
+columns, so the output of two builds can be diffed or loaded into a spreadsheet:
+
+benchmark   ops   ns/op   ops/s   allocs/op
+
+allocs/op counts calls to operator new while the benchmark runs, divided by the operations.
+
+Built with the rest of the project (target bench_blackjack), run from the repository root so the
+6 deck basic strategy chart is found:
+./build/release/bench_blackjack [--scale F] [--seed S]
+*/
+
+#include "blackjack.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace blackjack;
+
+// GCC sees the replaced operator new below inlined into the library and flags the matching free
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Allocation counter, every operator new of the program goes through here
+atomic<long long> g_allocations(0);
+
+void* operator new(size_t size) {
+    g_allocations++;
+    void* memory = malloc(size ? size : 1);
+    if (memory == nullptr) {
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    free(memory);
+}
+
+// Results are folded into this so the compiler can't drop the work being timed
+volatile long long g_sink = 0;
+
+// Structure for a running benchmark: the clock and the allocation count at the start
+struct BenchTimer {
+
+    chrono::steady_clock::time_point start;
+    long long allocations;
+
+    // Constructor for BenchTimer, starts timing
+    BenchTimer() {
+        allocations = g_allocations;
+        start = chrono::steady_clock::now();
+    }
+};
+
+// Prints the result line of a benchmark that ran ops operations since the timer started
+void report(const string& name, const BenchTimer& timer, long long ops) {
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - timer.start).count();
+    long long allocations = g_allocations - timer.allocations;
+    cout << name << "\t" << ops << "\t" << fixed << setprecision(2) << seconds * 1e9 / ops << "\t"
+         << setprecision(0) << ops / seconds << "\t" << setprecision(4) << (double)allocations / ops << "\n";
+}
+
+// Shuffling a full 6 deck shoe
+void benchShuffle(long long ops, uint64_t seed) {
+
+    Shoe shoe;
+    Rng rng;
+    seedRng(rng, RNG_XOSHIRO, seed, 0);
+    getNewDeck(shoe, 6, DEFAULT_PENETRATION);
+
+    BenchTimer timer;
+    for (long long i = 0; i < ops; i++) {
+        shuffleDeck(shoe, rng);
+        g_sink += shoe.cards[0].code;
+    }
+    report("shuffleDeck_6d", timer, ops);
+    freeShoe(shoe);
+}
+
+// Dealing one card from the shoe into a hand, the part of deal() that isn't printing.
+// Hands are emptied every few cards and the shoe reshuffles itself when it runs out.
+void benchDeal(long long ops, uint64_t seed) {
+
+    Shoe shoe;
+    Rng rng;
+    seedRng(rng, RNG_XOSHIRO, seed, 1);
+    getNewDeck(shoe, 6, DEFAULT_PENETRATION);
+    shuffleDeck(shoe, rng);
+    CardArray hand;
+
+    BenchTimer timer;
+    for (long long i = 0; i < ops; i++) {
+        if (hand.usedCards == 4) {
+            clearHand(hand);
+        }
+        drawCard(shoe, hand, rng);
+    }
+    g_sink += hand.score + shoe.runningCount;
+    report("deal", timer, ops);
+    freeShoe(shoe);
+}
+
+// A batch of dealt hands of two to four cards to score and look up
+void dealHands(vector<CardArray>& hands, uint64_t seed) {
+
+    Shoe shoe;
+    Rng rng;
+    seedRng(rng, RNG_XOSHIRO, seed, 2);
+    getNewDeck(shoe, 6, DEFAULT_PENETRATION);
+    shuffleDeck(shoe, rng);
+    for (size_t h = 0; h < hands.size(); h++) {
+        int cards = 2 + randomBelow(rng, 3);
+        for (int c = 0; c < cards; c++) {
+            drawCard(shoe, hands[h], rng);
+        }
+    }
+    freeShoe(shoe);
+}
+
+// Scoring a hand with computeTotals
+void benchTotals(long long ops, uint64_t seed) {
+
+    vector<CardArray> hands(4096);
+    dealHands(hands, seed);
+
+    BenchTimer timer;
+    long long sum = 0;
+    for (long long i = 0; i < ops; i++) {
+        int soft = 0, hard = 0, aces = 0;
+        computeTotals(hands[i & 4095], soft, hard, aces);
+        sum += soft + hard + aces;
+    }
+    g_sink += sum;
+    report("computeTotals", timer, ops);
+}
+
+// Scoring hands 32 at a time with the batch evaluator, ops counts hands
+void benchBatchTotals(long long ops, uint64_t seed, int kind, const string& name) {
+
+    if (selectBatchEvaluator(kind) != kind) {
+        return;
+    }
+    vector<CardArray> hands(4096);
+    dealHands(hands, seed);
+    vector<HandBatch> batches(hands.size() / BATCH_LANES);
+    for (size_t h = 0; h < hands.size(); h++) {
+        for (int c = 0; c < hands[h].usedCards; c++) {
+            addBatchCard(batches[h / BATCH_LANES], (int)(h % BATCH_LANES), hands[h].cards[c]);
+        }
+    }
+
+    BenchTimer timer;
+    long long sum = 0;
+    long long evaluations = ops / BATCH_LANES + 1;
+    for (long long i = 0; i < evaluations; i++) {
+        HandBatch& batch = batches[i % batches.size()];
+        evaluateBatch(batch);
+        sum += batch.score[i % BATCH_LANES];
+    }
+    g_sink += sum;
+    report(name, timer, evaluations * BATCH_LANES);
+    selectBatchEvaluator(BATCH_AUTO);
+}
+
+// The advisor's decision: a strategy table lookup with all the two card options open
+void benchDecision(long long ops, uint64_t seed) {
+
+    vector<CardArray> hands(4096);
+    dealHands(hands, seed);
+    StrategyTable basic;
+    string error;
+    const StrategyTable* table = &BICYCLE_STRATEGY;
+    if (loadStrategy("strategies/basic_6d_s17.txt", basic, error)) {
+        table = &basic;
+    }
+
+    BenchTimer timer;
+    long long sum = 0;
+    for (long long i = 0; i < ops; i++) {
+        const CardArray& hand = hands[i & 4095];
+        int upValue = 1 + (int)(i % 10);
+        sum += strategyDecision(*table, hand, upValue, true, true, true);
+    }
+    g_sink += sum;
+    report("strategyDecision", timer, ops);
+}
+
+// Whole rounds through the simulator on one thread, from the deal to settlement
+void benchRounds(long long ops, uint64_t seed, int dealerMode, const string& name) {
+
+    SimConfig config;
+    config.strategy = &BICYCLE_STRATEGY;
+    config.rules.numDecks = 6;
+    config.dealerMode = dealerMode;
+    StrategyTable basic;
+    string error;
+    if (loadStrategy("strategies/basic_6d_s17.txt", basic, error)) {
+        config.strategy = &basic;
+    }
+    DealerTable dealerTable;
+    if (dealerMode == DEALER_SHOE || dealerMode == DEALER_INFINITE) {
+        buildDealerTable(dealerTable, config.rules, dealerMode);
+        config.dealerTable = &dealerTable;
+    }
+
+    // The batch dealer plays a full batch of shoes in lockstep
+    int count = (dealerMode == DEALER_BATCH) ? BATCH_LANES : 1;
+    vector<Shoe> shoes(count);
+    vector<Rng> rngs(count);
+    for (int k = 0; k < count; k++) {
+        seedRng(rngs[k], RNG_XOSHIRO, seed, 3 + k);
+        getNewDeck(shoes[k], config.rules.numDecks, config.penetration);
+        shuffleDeck(shoes[k], rngs[k]);
+    }
+
+    BenchTimer timer;
+    SimResult result = (dealerMode == DEALER_BATCH) ? simulateLanes(&shoes[0], &rngs[0], ops, config)
+                                                     : simulateHands(&shoes[0], &rngs[0], 1, ops, config);
+    g_sink += result.wins;
+    report(name, timer, ops);
+    for (int k = 0; k < count; k++) {
+        freeShoe(shoes[k]);
+    }
+}
+
+// Runs every benchmark. --scale multiplies the operation counts (e.g. 0.1 for a quick check)
+// and --seed fixes the cards so runs are comparable.
+int main(int argc, char* argv[])
+{
+    double scale = 1;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--scale" && i + 1 < argc) {
+            scale = atof(argv[++i]);
+        }
+        else if (arg == "--seed" && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else {
+            cerr << "Usage: " << argv[0] << " [--scale F] [--seed S]" << endl;
+            return 1;
+        }
+    }
+    if (scale <= 0) {
+        scale = 1;
+    }
+
+    cout << "benchmark\tops\tns/op\tops/s\tallocs/op\n";
+    benchShuffle((long long)(200000 * scale) + 1, seed);
+    benchDeal((long long)(100000000 * scale) + 1, seed);
+    benchTotals((long long)(200000000 * scale) + 1, seed);
+    benchBatchTotals((long long)(200000000 * scale) + 1, seed, BATCH_SCALAR, "evaluateBatch_scalar");
+    benchBatchTotals((long long)(200000000 * scale) + 1, seed, BATCH_AVX2, "evaluateBatch_avx2");
+    benchDecision((long long)(100000000 * scale) + 1, seed);
+    benchRounds((long long)(10000000 * scale) + 1, seed, DEALER_EXACT, "round_exact_dealer");
+    benchRounds((long long)(10000000 * scale) + 1, seed, DEALER_SHOE, "round_table_dealer");
+    benchRounds((long long)(10000000 * scale) + 1, seed, DEALER_BATCH, "round_batch_dealer");
+    return 0;
+}
@@ -0,0 +1,242 @@
+// Batch evaluation: scores many hands at once from a structure of arrays layout
+
+#include "blackjack.h"
+
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BLACKJACK_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+namespace blackjack {
+
+// Empties every hand of the batch. Only the card rows that were used need clearing.
+void clearBatch(HandBatch& batch) {
+
+    memset(batch.value, 0, sizeof(batch.value[0]) * batch.rows);
+    memset(batch.usedCards, 0, sizeof(batch.usedCards));
+    memset(batch.pending, 0, sizeof(batch.pending));
+    batch.rows = 0;
+}
+
+// Scores the lanes without AVX2, for other processors and as the reference. The rows are
+// summed one at a time over all lanes, which compilers turn into baseline vector code.
+void evaluateBatchScalar(HandBatch& batch) {
+
+    unsigned char hard[BATCH_LANES] = {};
+    unsigned char aces[BATCH_LANES] = {};
+    for (int row = 0; row < batch.rows; row++) {
+        const unsigned char* value = batch.value[row];
+        for (int lane = 0; lane < BATCH_LANES; lane++) {
+            hard[lane] += value[lane];
+            aces[lane] += (value[lane] == 1);
+        }
+    }
+    for (int lane = 0; lane < BATCH_LANES; lane++) {
+        bool soft = (aces[lane] > 0 && hard[lane] <= BLACKJACK - 10);
+        int score = soft ? hard[lane] + 10 : hard[lane];
+        batch.hardTotal[lane] = hard[lane];
+        batch.aceCount[lane] = aces[lane];
+        batch.score[lane] = (unsigned char)score;
+        batch.soft[lane] = soft;
+        batch.bust[lane] = (score > BLACKJACK);
+        batch.blackjack[lane] = (score == BLACKJACK && batch.usedCards[lane] == 2);
+    }
+}
+
+#ifdef BLACKJACK_HAS_AVX2
+// Scores all 32 lanes together, one byte per hand. A hand never holds more than 21 cards of
+// at most 10, so the byte sums can't overflow. Comparisons give 0xFF masks, which are turned
+// into the 0/1 flags the scalar version stores.
+__attribute__((target("avx2")))
+static void evaluateBatchAvx2(HandBatch& batch) {
+
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i hard = zero;
+    __m256i aces = zero;
+    for (int row = 0; row < batch.rows; row++) {
+        __m256i value = _mm256_load_si256((const __m256i*)batch.value[row]);
+        hard = _mm256_add_epi8(hard, value);
+        aces = _mm256_sub_epi8(aces, _mm256_cmpeq_epi8(value, one));
+    }
+
+    // Soft when there is an Ace and the hard total is 11 or less (min(hard, 11) == hard)
+    __m256i hasAce = _mm256_xor_si256(_mm256_cmpeq_epi8(aces, zero), _mm256_set1_epi8(-1));
+    __m256i low = _mm256_cmpeq_epi8(_mm256_min_epu8(hard, _mm256_set1_epi8(BLACKJACK - 10)), hard);
+    __m256i soft = _mm256_and_si256(hasAce, low);
+    __m256i score = _mm256_add_epi8(hard, _mm256_and_si256(soft, _mm256_set1_epi8(10)));
+
+    // Bust when max(score, 22) == score, blackjack is 21 with two cards
+    __m256i bust = _mm256_cmpeq_epi8(_mm256_max_epu8(score, _mm256_set1_epi8(BLACKJACK + 1)), score);
+    __m256i twoCards = _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i*)batch.usedCards), _mm256_set1_epi8(2));
+    __m256i natural = _mm256_and_si256(twoCards, _mm256_cmpeq_epi8(score, _mm256_set1_epi8(BLACKJACK)));
+
+    _mm256_store_si256((__m256i*)batch.hardTotal, hard);
+    _mm256_store_si256((__m256i*)batch.aceCount, aces);
+    _mm256_store_si256((__m256i*)batch.score, score);
+    _mm256_store_si256((__m256i*)batch.soft, _mm256_and_si256(soft, one));
+    _mm256_store_si256((__m256i*)batch.bust, _mm256_and_si256(bust, one));
+    _mm256_store_si256((__m256i*)batch.blackjack, _mm256_and_si256(natural, one));
+}
+#endif
+
+// Whether this build and processor can run an evaluator
+static bool batchSupported(int kind) {
+
+    if (kind == BATCH_SCALAR) {
+        return true;
+    }
+#ifdef BLACKJACK_HAS_AVX2
+    if (kind == BATCH_AVX2) {
+        // Also runs during static initialization, before the runtime has looked at the processor
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }
+#endif
+    return false;
+}
+
+// The evaluator in use, chosen the first time the library is loaded
+static int g_batch_kind = batchSupported(BATCH_AVX2) ? BATCH_AVX2 : BATCH_SCALAR;
+static void (*g_evaluate)(HandBatch&) =
+#ifdef BLACKJACK_HAS_AVX2
+    (g_batch_kind == BATCH_AVX2) ? evaluateBatchAvx2 :
+#endif
+    evaluateBatchScalar;
+
+// Switches the batch evaluator, BATCH_AUTO picks the fastest one the processor supports.
+// Falls back to scalar if the one asked for isn't available. Returns the one in use.
+// Call it before any simulation starts, workers read the choice without locking.
+int selectBatchEvaluator(int kind) {
+
+    if (kind == BATCH_AUTO) {
+        kind = batchSupported(BATCH_AVX2) ? BATCH_AVX2 : BATCH_SCALAR;
+    }
+    if (!batchSupported(kind)) {
+        kind = BATCH_SCALAR;
+    }
+    g_batch_kind = kind;
+    g_evaluate = evaluateBatchScalar;
+#ifdef BLACKJACK_HAS_AVX2
+    if (kind == BATCH_AVX2) {
+        g_evaluate = evaluateBatchAvx2;
+    }
+#endif
+    return kind;
+}
+
+// The batch evaluator in use, BATCH_SCALAR or BATCH_AVX2
+int batchEvaluator() {
+    return g_batch_kind;
+}
+
+// Computes hard totals, Ace counts, scores and the soft, bust and blackjack flags of every
+// hand in the batch with the selected evaluator
+void evaluateBatch(HandBatch& batch) {
+    g_evaluate(batch);
+}
+
+// Plays rounds on BATCH_LANES shoes in lockstep. The players' hands are played one shoe
+// at a time, then the dealer hands of every shoe are played out together with resolveDealers.
+// Each shoe deals its rounds in the same order as simulateRound, only the rounds of
+// different shoes are interleaved. With buckets every round is also added to its up card and
+// starting hand.
+template <typename R>
+static SimResult simulateLanesWith(Shoe* shoes, Rng* rngs, long long hands, const SimConfig& config, const R& rules,
+                                   HandBuckets* buckets) {
+
+    SimResult result;
+    const StrategyTable& strategy = *config.strategy;
+    bool spreadBets = !config.spread.empty();
+
+    // Every lane's hands and the batch of dealer hands live on the stack for the whole run
+    PlayerHands players[BATCH_LANES];
+    double bets[BATCH_LANES];
+    double nets[BATCH_LANES];
+    bool settled[BATCH_LANES];
+    HandBatch dealers;
+
+    for (long long played = 0; played < hands; ) {
+        int lanes = (hands - played < BATCH_LANES) ? (int)(hands - played) : BATCH_LANES;
+        clearBatch(dealers);
+
+        // Bets from the count so far, then two cards each, alternating like the table does
+        for (int lane = 0; lane < lanes; lane++) {
+            Shoe& shoe = shoes[lane];
+            reshuffleAtCutCard(shoe, rngs[lane]);
+            bets[lane] = spreadBets ? betForCount(config.spread, trueCount(shoe)) : 1;
+            PlayerHands& player = players[lane];
+            resetHands(player);
+            drawCard(shoe, player.hands[0], rngs[lane]);
+            addBatchCard(dealers, lane, dealCard(shoe, rngs[lane]));
+            drawCard(shoe, player.hands[0], rngs[lane]);
+            addBatchCard(dealers, lane, dealCard(shoe, rngs[lane]));
+        }
+        evaluateBatch(dealers);
+
+        for (int lane = 0; lane < lanes; lane++) {
+            PlayerHands& player = players[lane];
+            const CardArray& first = player.hands[0];
+            int upValue = dealers.value[0][lane];
+            bool dealerBlackjack = dealers.blackjack[lane];
+            double net = 0;
+
+            // Insurance is settled when the dealer peeks
+            if (config.takeInsurance && upValue == 1) {
+                net = dealerBlackjack ? 2 * INSURANCE_BET : -INSURANCE_BET;
+            }
+
+            // Nobody acts when either side starts with 21
+            settled[lane] = dealerBlackjack || first.blackjack;
+            if (settled[lane]) {
+                net += settleHand(first.score, first.blackjack, dealers.score[lane], dealerBlackjack, 1, rules);
+            }
+            else {
+                dealers.pending[lane] = playHands(shoes[lane], rngs[lane], player, upValue, strategy, rules);
+                if (player.surrendered) {
+                    net -= SURRENDER_LOSS;
+                    settled[lane] = true;
+                }
+            }
+            nets[lane] = net;
+        }
+
+        resolveDealers(dealers, shoes, rngs, lanes, rules);
+
+        for (int lane = 0; lane < lanes; lane++) {
+            PlayerHands& player = players[lane];
+            double round = nets[lane];
+            if (!settled[lane]) {
+                for (int h = 0; h < player.count; h++) {
+                    round += settleHand(player.hands[h].score, false, dealers.score[lane], false, player.bets[h], rules);
+                }
+            }
+            double outcome = bets[lane] * round;
+            if (buckets != nullptr) {
+                addToBuckets(*buckets, dealers.value[0][lane], player, outcome);
+            }
+            tallyRound(result, outcome, bets[lane]);
+        }
+        played += lanes;
+    }
+    return result;
+}
+
+// Plays the rounds on BATCH_LANES shoes with the dealer hands resolved in batches.
+// The common rule sets run a copy compiled for them, anything else reads the rules as it goes.
+SimResult simulateLanes(Shoe* shoes, Rng* rngs, long long hands, const SimConfig& config, HandBuckets* buckets) {
+
+    if (matchesRules(config.rules, FixedRules<false>())) {
+        return simulateLanesWith(shoes, rngs, hands, config, FixedRules<false>(), buckets);
+    }
+    if (matchesRules(config.rules, FixedRules<true>())) {
+        return simulateLanesWith(shoes, rngs, hands, config, FixedRules<true>(), buckets);
+    }
+    return simulateLanesWith(shoes, rngs, hands, config, config.rules, buckets);
+}
+
+} // namespace blackjack
@@ -0,0 +1,1599 @@
+/*
+Core of the blackjack engine: cards and shoes, hands and scoring, table rules, the strategy
+tables the advisor reads, headless simulation, exact dealer odds and the EV solver.
+
+Everything lives in namespace blackjack and nothing here reads global state, so the game, the
+simulator, the benchmarks and any other tool link the same library (see CMakeLists.txt).
+*/
+
+#ifndef BLACKJACK_H
+#define BLACKJACK_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#ifdef BLACKJACK_PROFILE
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+namespace blackjack {
+
+// STRUCTORS and CONSTRUCTORS
+
+// Structure for Card, rank and suit packed in one byte so decks and hands copy like plain bytes.
+// Bits 0-3 hold the rank (1-13, 1 is Ace 13 is King, 0 is no card) and bits 4-5 the suit
+// (Spades, Hearts, Diamonds, Clubs). Value and display text are looked up from the rank
+// (see HARD_VALUE and cardName).
+struct Card {
+
+    unsigned char code; // packed rank and suit
+
+    // Constructor for Card
+    Card() {
+        code = 0;
+    }
+};
+
+// Room for the longest possible hand: twenty Aces still total only 20, the next card ends it
+const int MAX_CARDS_IN_HAND = 21;
+
+// Structure for a hand of cards. The cards are stored inline, so a hand on the stack or
+// inside another structure never allocates and needs no cleanup. Cards are only added
+// with addCard, which keeps the totals and flags up to date, so scoring is a field read.
+struct CardArray {
+
+    Card cards[MAX_CARDS_IN_HAND];  // cards in the order they were dealt
+    int usedCards;      // the number of cards in players or dealers hand currently
+    int hardTotal;      // total with every Ace counted as 1
+    int aceCount;       // Aces in the hand
+    int score;          // total that counts: one Ace as 11 when that doesn't bust, else hardTotal
+    bool soft;          // score counts an Ace as 11
+    bool blackjack;     // 21 with two cards (a natural only on the original hand)
+    bool bust;          // score is over 21
+
+    // Constructor for CardArray
+    CardArray() {
+        usedCards = 0;
+        hardTotal = 0;
+        aceCount = 0;
+        score = 0;
+        soft = false;
+        blackjack = false;
+        bust = false;
+    }
+};
+
+// Random number generator backends
+const int RNG_XOSHIRO = 0;      // xoshiro256**, 256 bit state, the default
+const int RNG_PCG = 1;          // PCG32 (XSH-RR), 64 bit state with a per stream increment
+const int RNG_SPLITMIX = 2;     // splitmix64, fastest, 64 bit state with a per stream gamma
+const int RNG_KINDS = 3;
+
+// Structure for a random number generator with a selectable backend.
+// Every shoe owner keeps its own, so simulations on different threads never share state.
+struct Rng {
+
+    int kind;           // which backend produces the numbers (RNG_XOSHIRO, RNG_PCG, RNG_SPLITMIX)
+    uint64_t s[4];      // generator state, xoshiro uses all four words, pcg and splitmix the first two
+
+    // Constructor for Rng
+    Rng() {
+        kind = RNG_XOSHIRO;
+        s[0] = 1;
+        s[1] = 2;
+        s[2] = 3;
+        s[3] = 4;
+    }
+};
+
+// Rows and columns of a strategy table.
+// Rows 0-21 are hard totals, 22-43 soft totals (22 + total) and 44-54 pairs (44 + card value).
+// Columns are the dealer up card value, 1 is an Ace and 10 any ten valued card, column 0 is unused.
+const int SOFT_ROWS = 22;
+const int PAIR_ROWS = 44;
+const int STRATEGY_ROWS = 55;
+const int STRATEGY_COLUMNS = 11;
+
+// Structure for a basic strategy table: one action per (player hand, dealer up card).
+// Small enough (605 bytes) to stay in L1 cache, a decision is a single indexed load.
+struct StrategyTable {
+
+    unsigned char action[STRATEGY_ROWS][STRATEGY_COLUMNS];  // STAND, HIT, DOUBLE, ... for each cell
+};
+
+// Structure for a shoe of one or more decks with a cut card.
+// The cards are allocated once and reshuffled in place, dealing just advances an index.
+struct Shoe {
+
+    Card* cards;        // every card of every deck in the shoe
+    int numDecks;       // number of 52 card decks in the shoe
+    int size;           // total number of cards (numDecks * 52)
+    int nextCard;       // index of the next card to deal
+    int cutCard;        // once nextCard passes this index the shoe is reshuffled before the next round
+    int countSystem;    // card counting system whose tags runningCount adds up (0 is Hi-Lo)
+    int runningCount;   // count of the cards dealt since the last shuffle
+
+    // Constructor for Shoe
+    Shoe() {
+        cards = nullptr;
+        numDecks = 0;
+        size = 0;
+        nextCard = 0;
+        cutCard = 0;
+        countSystem = 0;
+        runningCount = 0;
+    }
+};
+
+// GLOBAL CONSTANTS
+
+// Constants related to blackjack rules.
+const int MAX_DECK_SIZE = 52;
+const int MAX_DECKS_IN_SHOE = 8;
+const int MAX_CARDS_IN_SUIT = 13;
+const int BLACKJACK = 21;
+const int DEALER_MIN = 17;
+
+// Constants for creating a card
+const std::string SUIT[] = { "S", "H", "D", "C" };
+const std::string RANK[] = { "A", "2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K" };
+const int RANK_VALUE[] = { 1, 2,   3,   4,   5,   6,   7,   8,   9,   10,  11,  12,  13 };
+
+// Card values indexed by rank (0 is no card), Ace counted as 1
+const int HARD_VALUE[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 10, 10, 10 };
+
+// Bit layout of Card::code
+const unsigned char RANK_MASK = 0x0F;
+const int SUIT_SHIFT = 4;
+const unsigned char SUIT_MASK = 0x03;
+
+// Constants for visual display of player and dealer hands
+const int VISIBLE = 0;
+const int HIDDEN = 1;
+
+// Constants for win, lose, draw
+const int WIN = 1;
+const int LOSE = -1;
+const int DRAW = 0;
+
+// Constants for splits, doubles, insurance and surrender
+const int MAX_SPLIT_HANDS = 4;          // room for hands in a round, the most any rule set can split into
+const int MAX_ROUND_ACTIONS = MAX_SPLIT_HANDS * (MAX_CARDS_IN_HAND + 1);    // every decision but a stand draws a card
+const double INSURANCE_BET = 0.5;       // insurance costs half the bet and pays 2 to 1
+const double SURRENDER_LOSS = 0.5;      // late surrender gives back half the bet
+
+// Card counting systems, indexed by Shoe::countSystem
+const int COUNT_HILO = 0;
+const int COUNT_KO = 1;
+const int COUNT_OMEGA2 = 2;
+const int COUNT_SYSTEMS = 3;
+const std::string COUNT_NAMES[] = { "hilo", "ko", "omega2" };
+
+// Count tags indexed by system and rank (0 is no card, 1 is Ace, 11-13 are faces)
+const int COUNT_TAGS[COUNT_SYSTEMS][14] = {
+    { 0, -1, 1, 1, 1, 1, 1, 0, 0,  0, -1, -1, -1, -1 },    // Hi-Lo
+    { 0, -1, 1, 1, 1, 1, 1, 1, 0,  0, -1, -1, -1, -1 },    // KO (unbalanced)
+    { 0,  0, 1, 1, 2, 2, 2, 1, 0, -1, -2, -2, -2, -2 }     // Omega II
+};
+
+// Bankroll in betting units used for the risk of ruin unless --bankroll is given
+const double DEFAULT_BANKROLL = 1000;
+
+// How the simulated dealer finishes a hand: drawing from the shoe, one draw from a
+// precomputed outcome table for a full shoe or for an infinite deck, or drawing from the
+// shoe with the dealer hands of many shoes played in lockstep by the batch evaluator
+const int DEALER_EXACT = 0;
+const int DEALER_SHOE = 1;
+const int DEALER_INFINITE = 2;
+const int DEALER_BATCH = 3;
+const std::string DEALER_MODE_NAMES[] = { "exact", "shoe", "infinite", "batch" };
+
+// Default shoe: one deck, reshuffled once three quarters of it have been dealt
+const int DEFAULT_DECKS = 1;
+const double DEFAULT_PENETRATION = 0.75;
+
+// Structure for the table rules, read by the dealer loop and when hands are settled
+struct Rules {
+
+    bool hitSoft17;         // dealer hits soft 17 (H17) instead of standing on it (S17)
+    double blackjackPays;   // units a natural wins: 1.5 for 3:2, 1.2 for 6:5
+    bool doubleAfterSplit;  // hands made by a split may be doubled
+    int maxHands;           // resplit limit: hands a pair can be split into (1 = no splits)
+    bool surrender;         // late surrender is offered
+    int numDecks;           // decks in the shoe
+
+    // Constructor for Rules, S17 3:2 DAS with resplits to 4 hands and late surrender
+    Rules() {
+        hitSoft17 = false;
+        blackjackPays = 1.5;
+        doubleAfterSplit = true;
+        maxHands = MAX_SPLIT_HANDS;
+        surrender = true;
+        numDecks = DEFAULT_DECKS;
+    }
+};
+
+// Common rule sets with every rule fixed at compile time. Code templated on the rules
+// type reads them exactly like a Rules object, but the checks fold into constants.
+template <bool HitSoft17>
+struct FixedRules {
+
+    static constexpr bool hitSoft17 = HitSoft17;
+    static constexpr double blackjackPays = 1.5;
+    static constexpr bool doubleAfterSplit = true;
+    static constexpr int maxHands = MAX_SPLIT_HANDS;
+    static constexpr bool surrender = true;
+};
+
+// Names of the random number generator backends, indexed by RNG_XOSHIRO, RNG_PCG, RNG_SPLITMIX
+const std::string RNG_NAMES[] = { "xoshiro", "pcg", "splitmix" };
+
+// Constants for advisor
+const int GOOD_CARD = 1;
+const int BAD_CARD = -1;
+const int FAIR_CARD = 0;
+
+// Up card values where a fair card turns bad and a bad card turns good (2-3 fair, 4-6 bad, 7-A good)
+const int BAD_CARD_VALUE = 4;
+const int GOOD_CARD_VALUE = 7;
+
+// Score the player should draw to for each kind of dealer up card (Bicycle strategy)
+const int GOOD_CARD_TARGET = 17;
+const int BAD_CARD_TARGET = 12;
+const int FAIR_CARD_TARGET = 13;
+
+// Constants for player decisions (strategy table actions).
+// DOUBLE hits and DOUBLE_STAND stands when doubling isn't allowed, same for the surrenders.
+const int STAND = 0;
+const int HIT = 1;
+const int DOUBLE = 2;
+const int DOUBLE_STAND = 3;
+const int SPLIT = 4;
+const int SURRENDER = 5;
+const int SURRENDER_STAND = 6;
+const int ACTION_COUNT = 7;
+
+// Strategy file codes and display names, indexed by action
+const std::string ACTION_CODES[] = { "S", "H", "D", "Ds", "P", "R", "Rs" };
+const std::string ACTION_NAMES[] = { "STAND", "HIT", "DOUBLE", "DOUBLE", "SPLIT", "SURRENDER", "SURRENDER" };
+
+// Classifies a dealer up card value (1 is an Ace) as GOOD_CARD, BAD_CARD or FAIR_CARD.
+// Cards below badValue are fair, below goodValue bad, the rest and the Ace good.
+constexpr int upCardClass(int upValue, int badValue = BAD_CARD_VALUE, int goodValue = GOOD_CARD_VALUE) {
+    return (1 < upValue && upValue < badValue) ? FAIR_CARD
+         : (badValue <= upValue && upValue < goodValue) ? BAD_CARD
+         : GOOD_CARD;
+}
+
+// Builds a strategy table at compile time from "hit until the score reaches the target"
+// rules, one target per kind of up card. Soft hands use the soft total, pairs are never split.
+constexpr StrategyTable makeTargetStrategy(int goodTarget, int badTarget, int fairTarget,
+                                           int badValue = BAD_CARD_VALUE, int goodValue = GOOD_CARD_VALUE) {
+
+    StrategyTable table = {};
+    for (int up = 1; up < STRATEGY_COLUMNS; up++) {
+        int upClass = upCardClass(up, badValue, goodValue);
+        int target = (upClass == GOOD_CARD) ? goodTarget : (upClass == BAD_CARD) ? badTarget : fairTarget;
+
+        for (int total = 0; total <= BLACKJACK; total++) {
+            table.action[total][up] = (total < target) ? HIT : STAND;
+            table.action[SOFT_ROWS + total][up] = (total < target) ? HIT : STAND;
+        }
+        for (int value = 1; value <= 10; value++) {
+            // A pair of aces is a soft 12, any other pair a hard total
+            int total = (value == 1) ? 12 : value * 2;
+            table.action[PAIR_ROWS + value][up] = (total < target) ? HIT : STAND;
+        }
+    }
+    return table;
+}
+
+// Built in strategies, generated at compile time
+inline constexpr StrategyTable BICYCLE_STRATEGY = makeTargetStrategy(GOOD_CARD_TARGET, BAD_CARD_TARGET, FAIR_CARD_TARGET);
+inline constexpr StrategyTable MIMIC_DEALER_STRATEGY = makeTargetStrategy(DEALER_MIN, DEALER_MIN, DEALER_MIN);
+inline constexpr StrategyTable NEVER_BUST_STRATEGY = makeTargetStrategy(12, 12, 12);
+
+
+// Function prototypes
+
+//////////////////// PART 1 Library /////////////////////////
+void getNewDeck(Shoe& shoe, int numDecks, double penetration);
+void freeShoe(Shoe& shoe);
+void shuffleDeck(Shoe& shoe, Rng& rng);
+bool reshuffleAtCutCard(Shoe& shoe, Rng& rng);
+void seedRng(Rng& rng, int kind, uint64_t seed, uint64_t stream);
+uint64_t nextRandom(Rng& rng);
+uint32_t nextRandom32(Rng& rng);
+int randomBelow(Rng& rng, int bound);
+int rngByName(const std::string& name);
+
+//////////////////// PART 2 Library /////////////////////////
+
+// Structure for every hand the player holds in one round. Hands keep their cards inline,
+// so splits only move cards between slots and a round never touches the heap.
+struct PlayerHands {
+
+    CardArray hands[MAX_SPLIT_HANDS];                   // hands in the order they are played
+    double bets[MAX_SPLIT_HANDS];                       // bet on each hand in units (2 after a double)
+    bool splitAces[MAX_SPLIT_HANDS];                    // hand came from splitting Aces, one card only
+    int count;                                          // hands in play
+    bool surrendered;                                   // player gave up the first hand
+    double insurance;                                   // insurance bet in units, 0 if declined
+    unsigned char actions[MAX_ROUND_ACTIONS];           // decisions in the order they were made (simulator)
+    int actionCount;                                    // decisions made this round
+
+    // Constructor for PlayerHands
+    PlayerHands() {
+        for (int h = 0; h < MAX_SPLIT_HANDS; h++) {
+            bets[h] = 1;
+            splitAces[h] = false;
+        }
+        count = 1;
+        surrendered = false;
+        insurance = 0;
+        actionCount = 0;
+    }
+};
+
+void resetHands(PlayerHands& player);
+template <typename R> bool canSplitHand(const PlayerHands& player, int h, const R& rules);
+template <typename R> bool canDoubleHand(const PlayerHands& player, int h, const R& rules);
+template <typename R> bool canSurrenderHand(const PlayerHands& player, int h, const R& rules);
+void splitHand(PlayerHands& player, int h);
+template <typename R> bool dealerHits(const CardArray& dealerHand, const R& rules);
+template <typename R> double settleHand(int playerScore, bool playerBlackjack, int dealerScore,
+                                        bool dealerBlackjack, double bet, const R& rules);
+template <typename F> bool matchesRules(const Rules& rules, const F& fixed);
+bool parsePayout(const std::string& text, double& pays);
+std::string rulesName(const Rules& rules);
+bool readRulesOption(int argc, char* argv[], int& i, Rules& rules, std::string& error);
+bool checkRules(const Rules& rules, std::string& error);
+std::string rulesUsage();
+
+//////////////////// PART 4 Library /////////////////////////
+// Hand totals, kept up to date as cards are added
+bool addCard(CardArray& hand, Card card);
+void clearHand(CardArray& hand);
+
+//////////////////// PART 5 Library /////////////////////////
+int cardEvlauator(const CardArray& hand);
+void computeTotals(const CardArray& hand, int &softTotal, int &hardTotal, int &aceCount);
+
+//////////////////// PART 17 Library /////////////////////////
+// Streaming statistics: running mean and variance of the per hand results, confidence
+// intervals, and the results split by dealer up card and starting hand
+
+// Starting hands are bucketed as hard 4-20, soft 12-20 and blackjack
+const int HARD_START_MIN = 4;
+const int HARD_START_MAX = 20;
+const int SOFT_START_MIN = 12;
+const int SOFT_START_MAX = 20;
+const int START_BUCKETS = (HARD_START_MAX - HARD_START_MIN + 1) + (SOFT_START_MAX - SOFT_START_MIN + 1) + 1;
+// Dealer up cards are bucketed Ace (1) to 10
+const int UPCARD_BUCKETS = 10;
+// Confidence level of the reported intervals unless one is given
+const double DEFAULT_CONFIDENCE = 0.95;
+// Fewest hands played between two checks of a run that stops at a target precision, also the
+// first block before there is a variance to size the next one from
+const long long PRECISION_MIN_HANDS = 10000;
+
+// Structure for the running mean and variance of a stream of results (Welford's method).
+// Unlike a sum of squares it stays accurate over billions of hands.
+struct RunningStats {
+
+    long long count;    // results added
+    double mean;        // mean of the results so far
+    double m2;          // sum of the squared differences from the mean
+
+    // Constructor for RunningStats
+    RunningStats() {
+        count = 0;
+        mean = 0;
+        m2 = 0;
+    }
+};
+
+// Adds one result to the running mean and variance
+inline void addSample(RunningStats& stats, double x) {
+
+    stats.count++;
+    double delta = x - stats.mean;
+    stats.mean += delta / stats.count;
+    stats.m2 += delta * (x - stats.mean);
+}
+
+// Structure for the per hand results split by the dealer's up card and by the player's first
+// two cards (a split pair counts as the pair)
+struct HandBuckets {
+
+    RunningStats byUpcard[UPCARD_BUCKETS];  // index up card value - 1, Ace first
+    RunningStats byStart[START_BUCKETS];    // index from startBucket
+};
+
+void mergeStats(RunningStats& total, const RunningStats& part);
+double sampleVariance(const RunningStats& stats);
+double standardError(const RunningStats& stats);
+double normalQuantile(double p);
+double confidenceHalfWidth(const RunningStats& stats, double confidence);
+long long precisionBlock(const RunningStats& stats, double precision, double confidence);
+int startBucket(const PlayerHands& player);
+std::string startBucketName(int bucket);
+void addToBuckets(HandBuckets& buckets, int upValue, const PlayerHands& player, double outcome);
+void mergeBuckets(HandBuckets& total, const HandBuckets& part);
+void printBuckets(const HandBuckets& buckets, double confidence);
+
+//////////////////// PART 6 Library /////////////////////////
+// Headless simulation: plays hands with no console I/O and only keeps totals
+
+// Structure for the aggregate results of a simulation run
+struct SimResult {
+
+    long long handsPlayed;  // number of hands resolved
+    long long wins;         // hands won by the player
+    long long losses;       // hands lost by the player
+    long long draws;        // hands that were tied
+    double totalReturn;     // sum of the per hand results in betting units (EV = totalReturn / handsPlayed)
+    double totalWagered;    // sum of the starting bets in units (handsPlayed when betting flat)
+    RunningStats returns;   // running mean and variance of the per hand results
+
+    // Constructor for SimResult
+    SimResult() {
+        handsPlayed = 0;
+        wins = 0;
+        losses = 0;
+        draws = 0;
+        totalReturn = 0;
+        totalWagered = 0;
+    }
+};
+
+// Adds one finished round to the tallies, a round counts as won or lost by its net result
+inline void tallyRound(SimResult& result, double outcome, double bet) {
+
+    result.handsPlayed++;
+    result.totalReturn += outcome;
+    result.totalWagered += bet;
+    addSample(result.returns, outcome);
+    if (outcome > 0) {
+        result.wins++;
+    }
+    else if (outcome < 0) {
+        result.losses++;
+    }
+    else {
+        result.draws++;
+    }
+}
+
+// Per thread slot for simulation results, padded to its own cache line so
+// workers never write to a line another worker is using
+struct alignas(64) WorkerResult {
+
+    SimResult result;
+    HandBuckets buckets;    // filled when the run asks for the breakdown
+};
+
+// Structure for one worker's shoes and random streams, kept from one block of hands to the next
+struct SimWorker {
+
+    std::vector<Shoe> shoes;
+    std::vector<Rng> rngs;
+    int stream;             // first random stream of the worker
+};
+
+struct DealerTable;
+struct HistoryFile;
+struct HistoryLog;
+struct HistoryWriter;
+
+// Settings shared by every worker of a simulation run
+struct SimConfig {
+
+    const StrategyTable* strategy;  // how the player decides to hit or stand
+    Rules rules;            // table rules, also the decks in each worker's shoe
+    double penetration;     // fraction of the shoe dealt before the cut card
+    int rngKind;            // random number generator backend for every worker
+    int shuffleBatch;       // shoes each worker keeps and shuffles together (1 = one shoe)
+    bool takeInsurance;     // insure every hand when the dealer shows an Ace
+    int countSystem;        // counting system the shoes keep a count with
+    std::vector<double> spread;  // bet for true count 1, 2, 3, ... (empty = flat one unit bets)
+    double bankroll;        // bankroll in units for the risk of ruin
+    int dealerMode;         // DEALER_EXACT, DEALER_SHOE or DEALER_INFINITE
+    const DealerTable* dealerTable;     // outcome table for the sampled modes, set by simulateParallel
+    HistoryFile* history;   // every shuffle and hand is logged here (nullptr = no log)
+    HistoryLog* replay;     // recorded log the hands are checked against (nullptr = not a replay)
+    double precision;       // stop once the EV interval is within this many units (0 = play every hand)
+    double confidence;      // confidence level of the reported intervals
+    bool buckets;           // break the results down by up card and starting hand
+
+    // Constructor for SimConfig
+    SimConfig() {
+        strategy = nullptr;
+        penetration = DEFAULT_PENETRATION;
+        rngKind = RNG_XOSHIRO;
+        shuffleBatch = 1;
+        takeInsurance = false;
+        countSystem = COUNT_HILO;
+        bankroll = DEFAULT_BANKROLL;
+        dealerMode = DEALER_EXACT;
+        dealerTable = nullptr;
+        history = nullptr;
+        replay = nullptr;
+        precision = 0;
+        confidence = DEFAULT_CONFIDENCE;
+        buckets = false;
+    }
+};
+
+bool drawCard(Shoe& shoe, CardArray& hand, Rng& rng);
+Card dealCard(Shoe& shoe, Rng& rng);
+int scoreOf(const CardArray& hand);
+int evaluateHand(int playerScore, bool playerBlackjack, int dealerScore, bool dealerBlackjack);
+template <typename R> bool playHands(Shoe& shoe, Rng& rng, PlayerHands& player, int upValue,
+                                     const StrategyTable& strategy, const R& rules);
+SimResult simulateHands(Shoe* shoes, Rng* rngs, int shoeCount, long long hands, const SimConfig& config,
+                        HistoryWriter* history = nullptr, HandBuckets* buckets = nullptr);
+void startWorker(SimWorker& worker, const SimConfig& config, uint64_t seed, int stream);
+void runWorker(SimWorker& worker, long long hands, const SimConfig& config, WorkerResult* out);
+void finishWorker(SimWorker& worker);
+SimResult simulateParallel(long long hands, const SimConfig& config, int threads, uint64_t seed,
+                           HandBuckets* buckets = nullptr);
+void mergeResults(SimResult& total, const SimResult& part);
+int runSimulation(long long hands, const std::string& policyName, const SimConfig& config, int threads, uint64_t seed);
+
+//////////////////// PART 11 Library /////////////////////////
+// Card counting: the shoe keeps a running count as cards are drawn, bets follow the true count
+
+void setCountSystem(Shoe& shoe, int system);
+void resetCount(Shoe& shoe);
+bool countIsBalanced(int system);
+double trueCount(const Shoe& shoe);
+int countByName(const std::string& name);
+bool parseSpread(const std::string& text, std::vector<double>& spread);
+double betForCount(const std::vector<double>& spread, double count);
+double riskOfRuin(double mean, double variance, double bankroll);
+
+//////////////////// PART 7 Library /////////////////////////
+// Shuffle engine: batched shuffling of many shoes and a statistical self-test
+
+void shuffleBatch(Shoe* shoes, Rng* rngs, int count);
+double chiSquarePValue(double chiSquare, double degrees);
+int runShuffleTest(long long shuffles, int numDecks, int rngKind, uint64_t seed);
+
+//////////////////// PART 8 Library /////////////////////////
+// Table driven strategy: decisions are looked up instead of worked out
+
+int handRow(const CardArray& hand, bool canSplit);
+int totalsRow(int softTotal, int hardTotal);
+int upCardValue(const CardArray& dealerHand);
+int resolveAction(const StrategyTable& table, int action, const CardArray& hand, int upValue,
+                  bool canDouble, bool canSurrender);
+int strategyDecision(const StrategyTable& table, const CardArray& hand, int upValue,
+                     bool canSplit, bool canDouble, bool canSurrender);
+const StrategyTable* strategyByName(const std::string& name);
+bool loadStrategy(const std::string& path, StrategyTable& table, std::string& error);
+const StrategyTable* selectStrategy(const std::string& policyName, const std::string& strategyFile,
+                                    StrategyTable& loaded, std::string& error);
+void printStrategy(const StrategyTable& table);
+
+//////////////////// PART 9 Library /////////////////////////
+// Exact dealer outcome probabilities for a given shoe composition
+
+// Dealer outcomes: final totals 17-21, a natural blackjack, or a bust
+const int DEALER_BLACKJACK = 5;
+const int DEALER_BUST = 6;
+const int DEALER_OUTCOMES = 7;
+
+// Structure for the composition of the unseen cards, counted by blackjack value
+struct ShoeCounts {
+
+    int count[11];      // cards left of each value, 1 is an Ace and 10 all tens and faces (index 0 unused)
+    int total;          // cards left in all
+
+    // Constructor for ShoeCounts
+    ShoeCounts() {
+        for (int v = 0; v < 11; v++) {
+            count[v] = 0;
+        }
+        total = 0;
+    }
+};
+
+// Structure for the dealer's final outcome distribution
+struct DealerOdds {
+
+    double p[DEALER_OUTCOMES];  // probability of 17, 18, 19, 20, 21, blackjack and bust
+
+    // Constructor for DealerOdds
+    DealerOdds() {
+        for (int i = 0; i < DEALER_OUTCOMES; i++) {
+            p[i] = 0;
+        }
+    }
+};
+
+// Key for a dealer position: the unseen composition plus the dealer's hand so far
+struct DealerKey {
+
+    uint64_t low;       // counts of Aces through nines, 6 bits each
+    uint64_t high;      // count of tens, hard total, ace in hand, first draw and peek flags
+
+    bool operator==(const DealerKey& other) const {
+        return low == other.low && high == other.high;
+    }
+};
+
+// Hash for DealerKey, mixes both words
+struct DealerKeyHash {
+
+    size_t operator()(const DealerKey& key) const {
+        uint64_t h = key.low * 0x9E3779B97F4A7C15ULL ^ (key.high + 0x632BE59BD9B4E019ULL);
+        return (size_t)(h ^ (h >> 29));
+    }
+};
+
+// Memo of dealer positions already worked out. Every thread keeps its own so lookups
+// never need a lock; the table is cleared when it grows past maxEntries.
+struct DealerCache {
+
+    std::unordered_map<DealerKey, DealerOdds, DealerKeyHash> table;  // finished positions
+    size_t maxEntries;      // size limit before the table is cleared
+    long long hits;         // lookups answered from the table
+    long long misses;       // positions that had to be worked out
+    bool hitSoft17;         // dealer rule the cached positions were solved for
+
+    // Constructor for DealerCache
+    DealerCache() {
+        hitSoft17 = false;
+        maxEntries = 1 << 22;
+        hits = 0;
+        misses = 0;
+    }
+};
+
+ShoeCounts fullShoeCounts(int numDecks);
+ShoeCounts remainingCounts(const Shoe& shoe);
+void removeValue(ShoeCounts& counts, int value);
+DealerKey dealerKey(const ShoeCounts& counts, int hardTotal, bool hasAce, bool firstDraw, bool peeked);
+DealerOdds dealerOddsFrom(DealerCache& cache, ShoeCounts& counts, int hardTotal, bool hasAce, bool firstDraw, bool peeked);
+DealerOdds dealerOdds(DealerCache& cache, const ShoeCounts& counts, int upValue, bool peeked);
+int runDealerOdds(const Rules& rules);
+
+// Structure for the dealer outcome distributions the simulator samples from, by peek state
+// and up card value (1 is an Ace), stored as running totals so one uniform draw picks an outcome
+struct DealerTable {
+
+    double cumulative[2][11][DEALER_OUTCOMES];
+};
+
+DealerOdds infiniteDealerOdds(int hardTotal, bool hasAce, bool firstDraw, bool peeked, bool hitSoft17);
+void buildDealerTable(DealerTable& table, const Rules& rules, int mode);
+int sampleDealer(const DealerTable& table, int upValue, bool peeked, Rng& rng);
+int dealerModeByName(const std::string& name);
+
+//////////////////// PART 10 Library /////////////////////////
+// Composition dependent expected value of every player action
+
+// Structure for the rules the solver plays by
+struct SolverOptions {
+
+    Rules rules;            // table rules: decks, dealer soft 17, doubling after split, surrender
+    bool peeked;            // dealer checks for blackjack first, so a hand that is played faces no natural
+
+    // Constructor for SolverOptions
+    SolverOptions() {
+        peeked = true;
+    }
+};
+
+// Structure for the expected value of each action, in units of the original bet
+struct ActionEV {
+
+    double ev[ACTION_COUNT];        // EV indexed by STAND, HIT, DOUBLE, SPLIT, SURRENDER
+    bool allowed[ACTION_COUNT];     // whether the action could be taken with this hand
+    int best;                       // allowed action with the highest EV
+
+    // Constructor for ActionEV
+    ActionEV() {
+        for (int a = 0; a < ACTION_COUNT; a++) {
+            ev[a] = 0;
+            allowed[a] = false;
+        }
+        best = STAND;
+    }
+};
+
+// Solver state: the rules plus the transposition caches for dealer and player positions.
+// Every thread needs its own, nothing in here is shared.
+struct EvSolver {
+
+    SolverOptions options;      // rules to solve for
+    DealerCache dealer;         // dealer outcome distributions by composition
+    std::unordered_map<DealerKey, double, DealerKeyHash> player;    // best hit/stand EV by (hand, composition, up card)
+    long long hits;             // player positions answered from the cache
+    long long misses;           // player positions that had to be worked out
+
+    // Constructor for EvSolver
+    EvSolver() {
+        hits = 0;
+        misses = 0;
+    }
+};
+
+double standEV(EvSolver& solver, ShoeCounts& counts, int playerScore, int upValue);
+double hitStandEV(EvSolver& solver, ShoeCounts& counts, int hardTotal, bool hasAce, int upValue);
+double hitEV(EvSolver& solver, ShoeCounts& counts, int hardTotal, bool hasAce, int upValue);
+double doubleEV(EvSolver& solver, ShoeCounts& counts, int hardTotal, bool hasAce, int upValue);
+double splitEV(EvSolver& solver, ShoeCounts& counts, int value, int upValue);
+ActionEV solveHand(EvSolver& solver, const ShoeCounts& unseen, const CardArray& hand, int upValue,
+                   bool canSplit, bool canDouble, bool canSurrender);
+int runSolveChart(const SolverOptions& options, int threads);
+
+//////////////////// PART 12 Library /////////////////////////
+// Hand history: a compact binary log of a simulation run and its bit-for-bit replay.
+// The file is a header with everything needed to rerun the simulation (seed, threads, rules,
+// strategy) followed by chunks of records. Every worker buffers its own records and appends a
+// whole chunk at a time, so workers only meet once per buffer. Records of one worker:
+//   shuffle: HISTORY_SHUFFLE, then the card codes of every shoe in the batch (the shoe order)
+//   reshuffle: HISTORY_RESHUFFLE, shoe index, then the new order of that one shoe, when it ran
+//            out and was reshuffled during the round recorded next
+//   hand:    HISTORY_HAND, shoe index, cards dealt, decision count, the decisions,
+//            result per unit bet in half units (or a double when it isn't a half unit),
+//            and the bet as a double when betting a spread
+
+const unsigned char HISTORY_MAGIC[] = { 'B', 'J', 'H', '1' };
+const unsigned char HISTORY_SHUFFLE = 'S';
+const unsigned char HISTORY_HAND = 'H';
+const unsigned char HISTORY_RESHUFFLE = 'R';
+const int HISTORY_MAX_CARDS = 255;              // cards one hand record can hold
+const size_t HISTORY_BUFFER = 1 << 20;          // bytes a worker collects before appending a chunk
+
+// Structure for a log file being written by the workers of one run
+struct HistoryFile {
+
+    std::ofstream out;      // the log, header first then chunks
+    std::mutex lock;        // held while a chunk is appended
+    bool failed;            // a write failed, the log is incomplete
+
+    // Constructor for HistoryFile
+    HistoryFile() {
+        failed = false;
+    }
+};
+
+// Structure for a recorded run read back for replay
+struct HistoryLog {
+
+    SimConfig config;                   // settings of the recorded run, strategy points at the table below
+    StrategyTable strategy;             // strategy the run played
+    uint64_t seed;                      // seed of the recorded run
+    long long hands;                    // hands played
+    int threads;                        // workers, each one has its own record stream
+    std::vector<std::vector<unsigned char> > streams;   // records of each worker, chunks joined
+    std::vector<long long> mismatch;    // first hand of each worker that replayed differently, -1 if none
+
+    // Constructor for HistoryLog
+    HistoryLog() {
+        seed = 0;
+        hands = 0;
+        threads = 0;
+    }
+};
+
+// Structure for one worker's side of the log. When recording, records collect in the buffer
+// and go to the file a chunk at a time. When replaying, each record is compared with the
+// recorded stream as soon as it is complete.
+struct HistoryWriter {
+
+    HistoryFile* file;                  // log being recorded, nullptr when replaying
+    HistoryLog* log;                    // log being replayed, nullptr when recording
+    int worker;                         // stream the records belong to
+    bool withBets;                      // hand records carry the bet (spread betting)
+    std::vector<unsigned char> buffer;  // records not yet written or compared
+    size_t used;                        // bytes of the buffer in use
+    size_t offset;                      // replay: bytes of the recorded stream matched so far
+    long long handsRecorded;            // hand records so far
+    long long mismatch;                 // replay: first hand that differs from the log, -1 if none
+
+    // Constructor for HistoryWriter
+    HistoryWriter() {
+        file = nullptr;
+        log = nullptr;
+        worker = 0;
+        withBets = false;
+        used = 0;
+        offset = 0;
+        handsRecorded = 0;
+        mismatch = -1;
+    }
+};
+
+bool openHistory(HistoryFile& file, const std::string& path, const SimConfig& config, long long hands,
+                 int threads, uint64_t seed, std::string& error);
+bool closeHistory(HistoryFile& file, std::string& error);
+void startHistory(HistoryWriter& writer, const SimConfig& config, int worker);
+void finishHistory(HistoryWriter& writer);
+void recordShuffle(HistoryWriter& writer, const Shoe* shoes, int count);
+void recordReshuffle(HistoryWriter& writer, int shoe, const Shoe& shuffled);
+void recordHand(HistoryWriter& writer, int shoe, int cardsDealt, const PlayerHands& player,
+                double bet, double result);
+bool readHistory(const std::string& path, HistoryLog& log, std::string& error);
+void dumpHistory(const HistoryLog& log);
+int runReplay(const std::string& path, bool dump);
+
+//////////////////// PART 13 Library /////////////////////////
+// Rendering: console text is collected into one buffer per frame, cards come from glyph
+// tables built when the mode is chosen, and a finished frame goes out in a single write.
+// The mode can be switched at any time, the null mode skips formatting altogether.
+
+const int RENDER_NULL = 0;          // nothing is formatted or written
+const int RENDER_PLAIN = 1;         // ASCII suits, no escape codes (logs and pipes)
+const int RENDER_ANSI = 2;          // ASCII suits with ANSI colors
+const int RENDER_UNICODE = 3;       // Unicode suit symbols with ANSI colors
+const int RENDER_MODES = 4;
+const std::string RENDER_NAMES[] = { "null", "plain", "ansi", "unicode" };
+
+// Text styles, looked up in the renderer's palette so plain output drops them
+struct Style {
+
+    int index;          // entry of Renderer::palette
+};
+
+const Style STYLE_NORMAL = { 0 };
+const Style STYLE_RED = { 1 };
+const Style STYLE_GREEN = { 2 };
+const Style STYLE_YELLOW = { 3 };
+const Style STYLE_BLUE = { 4 };
+const Style STYLE_MAGENTA = { 5 };
+const Style STYLE_CYAN = { 6 };
+const Style STYLE_BOLD = { 7 };
+const int STYLE_COUNT = 8;
+
+// A number written with a fixed number of decimals, optionally with its sign
+struct Number {
+
+    double value;       // number to write
+    int decimals;       // digits after the point
+    bool sign;          // write + for positive numbers
+};
+
+// Every card code a Card can hold (rank in bits 0-3, suit in bits 4-5)
+const int CARD_CODES = 64;
+
+// Structure for the console output of the game
+struct Renderer {
+
+    int mode;                               // RENDER_NULL, RENDER_PLAIN, RENDER_ANSI or RENDER_UNICODE
+    std::FILE* out;                         // where finished frames are written
+    std::string frame;                      // text of the frame being built
+    std::string palette[STYLE_COUNT];       // escape code of each style, empty without colors
+    std::string cardGlyph[CARD_CODES];      // a card in a hand, e.g. "[A♠] ", by card code
+    std::string nameGlyph[CARD_CODES];      // a card name right aligned in 4 columns, for shoe listings
+    std::string holeGlyph;                  // the dealer's face down card
+
+    // Constructor for Renderer, writes nothing until a mode is set
+    Renderer() {
+        mode = RENDER_NULL;
+        out = stdout;
+    }
+};
+
+void setRenderMode(Renderer& renderer, int mode);
+int renderModeByName(const std::string& name);
+void flushFrame(Renderer& renderer);
+void renderHand(Renderer& renderer, const CardArray& hand, int display);
+Renderer& operator<<(Renderer& renderer, const char* text);
+Renderer& operator<<(Renderer& renderer, const std::string& text);
+Renderer& operator<<(Renderer& renderer, char c);
+Renderer& operator<<(Renderer& renderer, int value);
+Renderer& operator<<(Renderer& renderer, long long value);
+Renderer& operator<<(Renderer& renderer, double value);
+Renderer& operator<<(Renderer& renderer, Style style);
+Renderer& operator<<(Renderer& renderer, Number number);
+
+// Number with a fixed number of decimals, e.g. fixedNumber(ev, 3, true) writes +0.012
+inline Number fixedNumber(double value, int decimals, bool sign = false) {
+    Number number;
+    number.value = value;
+    number.decimals = decimals;
+    number.sign = sign;
+    return number;
+}
+
+//////////////////// PART 14 Library /////////////////////////
+// Line protocol for bots: one command per input line, prefixed with a table number, and one
+// JSON object per output line. Any number of tables share the stream and commands can be
+// sent ahead of the answers, output is written whenever the input has been used up.
+
+const int MAX_PROTOCOL_TABLES = 4096;
+const double MAX_PROTOCOL_BET = 1e9;    // largest bet, doubled and split bets and the totals stay finite
+
+// Where a protocol table is in its round
+const int TABLE_CLOSED = 0;         // not opened yet, or closed by the bot
+const int TABLE_IDLE = 1;           // between rounds, waiting for deal
+const int TABLE_INSURANCE = 2;      // dealer shows an Ace, waiting for y or n
+const int TABLE_PLAYING = 3;        // waiting for the decision on the current hand
+
+// Structure for one table played over the protocol
+struct ProtocolTable {
+
+    Shoe shoe;              // the table's own shoe
+    Rng rng;                // the table's own random stream (stream number = table number)
+    PlayerHands player;     // hands of the round being played
+    CardArray dealerHand;   // dealer's cards, the second one is hidden until the round ends
+    bool holeCounted;       // the hidden card's tag is in the shoe's count (no reshuffle since it was dealt)
+    int phase;              // TABLE_CLOSED, TABLE_IDLE, TABLE_INSURANCE or TABLE_PLAYING
+    int current;            // hand waiting for a decision
+    long long rounds;       // rounds dealt at this table
+    double net;             // units won or lost at this table
+
+    // Constructor for ProtocolTable
+    ProtocolTable() {
+        holeCounted = false;
+        phase = TABLE_CLOSED;
+        current = 0;
+        rounds = 0;
+        net = 0;
+    }
+};
+
+// Structure for a protocol session: the settings every table is opened with, and the tables
+struct ProtocolSession {
+
+    Rules rules;                            // table rules, shared by every table
+    double penetration;                     // fraction of each shoe dealt before the cut card
+    int rngKind;                            // RNG_XOSHIRO, RNG_PCG or RNG_SPLITMIX
+    uint64_t seed;                          // table t uses stream t of this seed
+    int countSystem;                        // counting system of the reported counts
+    const StrategyTable* strategy;          // strategy of the advice sent with each decision
+    std::vector<ProtocolTable> tables;      // by table number, grown as tables are opened
+
+    // Constructor for ProtocolSession
+    ProtocolSession() {
+        penetration = DEFAULT_PENETRATION;
+        rngKind = RNG_XOSHIRO;
+        seed = 0;
+        countSystem = COUNT_HILO;
+        strategy = &BICYCLE_STRATEGY;
+    }
+};
+
+bool protocolCommand(ProtocolSession& session, const std::string& line, Renderer& out);
+int runProtocol(ProtocolSession& session, std::istream& in, Renderer& out);
+void closeTables(ProtocolSession& session);
+
+//////////////////// PART 15 Library /////////////////////////
+// Multi-seat tables: up to seven seats, each with its own strategy and bankroll, are dealt from
+// one shoe in table order and settled against one dealer hand
+
+const int MAX_SEATS = 7;
+const int MAX_TABLE_HANDS = MAX_SEATS * MAX_SPLIT_HANDS;
+
+// How a finished hand is settled
+const unsigned char HAND_PLAYED = 0;        // compared with the dealer's total
+const unsigned char HAND_NATURAL = 1;       // blackjack, paid at the rules' payout unless the dealer has one too
+const unsigned char HAND_SURRENDERED = 2;   // half the bet is lost
+
+// Finished hands of a round, in structure of arrays layout so settling every seat is one
+// pass over a few short arrays
+struct TableHands {
+
+    int count;                                  // hands finished this round
+    unsigned char seat[MAX_TABLE_HANDS];        // seat the hand belongs to
+    unsigned char kind[MAX_TABLE_HANDS];        // HAND_PLAYED, HAND_NATURAL or HAND_SURRENDERED
+    unsigned char score[MAX_TABLE_HANDS];       // final total of the hand
+    double bet[MAX_TABLE_HANDS];                // units riding on the hand (seat bet times doubles)
+
+    // Constructor for TableHands
+    TableHands() {
+        count = 0;
+    }
+};
+
+// Structure for the seats of a table, one array per field. The cards of each seat's round are
+// kept in its PlayerHands, what the seats are settled with is in TableHands.
+struct TableSeats {
+
+    int count;                                  // seats in use, filled from the dealer's left
+    const StrategyTable* strategy[MAX_SEATS];   // how each seat plays
+    double bankroll[MAX_SEATS];                 // units each seat has left
+    double bet[MAX_SEATS];                      // bet of each seat this round, 0 = sitting out
+    double roundNet[MAX_SEATS];                 // what each seat won or lost this round
+    PlayerHands hands[MAX_SEATS];               // cards of each seat this round
+    TableHands finished;                        // every hand of the round once played
+
+    // Constructor for TableSeats
+    TableSeats() {
+        count = 0;
+        for (int s = 0; s < MAX_SEATS; s++) {
+            strategy[s] = nullptr;
+            bankroll[s] = 0;
+            bet[s] = 0;
+            roundNet[s] = 0;
+        }
+    }
+};
+
+// Structure for the results of a table simulation, one SimResult per seat
+struct TableResult {
+
+    long long rounds;                   // rounds dealt at the table
+    SimResult seats[MAX_SEATS];         // per seat tallies, handsPlayed counts the rounds a seat played
+    double bankroll[MAX_SEATS];         // bankroll each seat finished with, summed over workers
+    int broke[MAX_SEATS];               // workers in which the seat could no longer cover a round
+
+    // Constructor for TableResult
+    TableResult() {
+        rounds = 0;
+        for (int s = 0; s < MAX_SEATS; s++) {
+            bankroll[s] = 0;
+            broke[s] = 0;
+        }
+    }
+};
+
+// Per thread slot for table results, padded to its own cache line
+struct alignas(64) TableWorkerResult {
+
+    TableResult result;
+};
+
+// Settings of a table simulation: the shared settings and one strategy and bankroll per seat
+struct TableConfig {
+
+    SimConfig sim;                              // rules, shoe, counting, spread and insurance for every seat
+    int seats;                                  // seats in use
+    const StrategyTable* strategy[MAX_SEATS];   // strategy of each seat
+    std::string names[MAX_SEATS];               // policy name or strategy file of each seat, for the report
+    double bankroll[MAX_SEATS];                 // bankroll each seat starts with, 0 = no limit
+
+    // Constructor for TableConfig
+    TableConfig() {
+        seats = 1;
+        for (int s = 0; s < MAX_SEATS; s++) {
+            strategy[s] = nullptr;
+            bankroll[s] = 0;
+        }
+    }
+};
+
+void settleTable(TableSeats& seats, const CardArray& dealerHand, double blackjackPays);
+TableResult simulateTable(Shoe& shoe, Rng& rng, long long rounds, const TableConfig& config);
+void tableWorker(long long rounds, const TableConfig& config, uint64_t seed, int stream, TableWorkerResult* out);
+int runTableSimulation(long long rounds, const TableConfig& config, int threads, uint64_t seed);
+
+//////////////////// PART 16 Library /////////////////////////
+// Batch evaluation: many independent hands scored together from a structure of arrays
+// layout, with AVX2 where the processor has it and a scalar loop everywhere else
+
+const int BATCH_LANES = 32;             // hands in a batch, one byte each in a 256 bit register
+
+// Evaluator implementations, picked at run time
+const int BATCH_AUTO = -1;              // the fastest one this processor supports
+const int BATCH_SCALAR = 0;
+const int BATCH_AVX2 = 1;
+const std::string BATCH_EVALUATOR_NAMES[] = { "scalar", "avx2" };
+
+struct HandBatch;
+void clearBatch(HandBatch& batch);
+
+// Structure for a batch of hands, one array per field with a byte per hand (lane).
+// Card rows past a hand's last card hold 0, so every lane can be summed over the same rows.
+// evaluateBatch fills in the totals and flags from the card values.
+struct alignas(32) HandBatch {
+
+    unsigned char value[MAX_CARDS_IN_HAND][BATCH_LANES];   // hard value (1-10) of each card, by row
+    unsigned char usedCards[BATCH_LANES];   // cards in each hand
+    unsigned char hardTotal[BATCH_LANES];   // total with every Ace counted as 1
+    unsigned char aceCount[BATCH_LANES];    // Aces in the hand
+    unsigned char score[BATCH_LANES];       // total that counts, one Ace as 11 when that doesn't bust
+    unsigned char soft[BATCH_LANES];        // 1 when score counts an Ace as 11
+    unsigned char bust[BATCH_LANES];        // 1 when score is over 21
+    unsigned char blackjack[BATCH_LANES];   // 1 for 21 with two cards
+    unsigned char pending[BATCH_LANES];     // 1 while the lane's dealer hand still has to be played
+    int rows;                               // most cards in any hand, the rows evaluateBatch reads
+
+    // Constructor for HandBatch
+    HandBatch() {
+        rows = MAX_CARDS_IN_HAND;
+        clearBatch(*this);
+    }
+};
+
+int selectBatchEvaluator(int kind);
+int batchEvaluator();
+void evaluateBatch(HandBatch& batch);
+void evaluateBatchScalar(HandBatch& batch);
+template <typename R> void resolveDealers(HandBatch& dealers, Shoe* shoes, Rng* rngs, int lanes, const R& rules);
+SimResult simulateLanes(Shoe* shoes, Rng* rngs, long long hands, const SimConfig& config,
+                        HandBuckets* buckets = nullptr);
+
+//////////////////// PART 18 Library /////////////////////////
+// Strategy comparison with common random numbers: every policy plays each round from the
+// same shoe position, so the differences between them are measured on identical cards
+
+const int MAX_COMPARE_POLICIES = 8;
+
+// Structure for the results of a comparison run, the first policy is the baseline
+struct CompareResult {
+
+    long long rounds;                                   // rounds every policy played
+    SimResult policies[MAX_COMPARE_POLICIES];           // each policy's own tallies
+    RunningStats differences[MAX_COMPARE_POLICIES];     // round result minus the baseline's (first unused)
+
+    // Constructor for CompareResult
+    CompareResult() {
+        rounds = 0;
+    }
+};
+
+// Per thread slot for comparison results, on its own cache line
+struct alignas(64) CompareWorkerResult {
+
+    CompareResult result;
+};
+
+// Settings of a comparison run
+struct CompareConfig {
+
+    SimConfig sim;                                      // shoe, rules, bets and stopping, shared by all
+    int policies;                                       // policies compared, the first is the baseline
+    const StrategyTable* strategy[MAX_COMPARE_POLICIES];
+    std::string names[MAX_COMPARE_POLICIES];
+
+    // Constructor for CompareConfig
+    CompareConfig() {
+        policies = 0;
+        for (int p = 0; p < MAX_COMPARE_POLICIES; p++) {
+            strategy[p] = nullptr;
+        }
+    }
+};
+
+void mergeCompare(CompareResult& total, const CompareResult& part);
+CompareResult compareRounds(Shoe& shoe, Rng& rng, long long rounds, const CompareConfig& config);
+void compareWorker(SimWorker& worker, long long rounds, const CompareConfig& config, CompareWorkerResult* out);
+int runComparison(long long rounds, const CompareConfig& config, int threads, uint64_t seed);
+
+//////////////////// PART 20 Library /////////////////////////
+// Threshold optimizer: searches the advisor's hit-to-target parameters, the three targets and
+// the two up card boundaries, by racing candidates against each other on common random numbers
+
+const int OPTIMIZE_TARGET_MIN = 12;     // lowest target searched, below it a hit can't bust
+const int OPTIMIZE_TARGET_MAX = 20;
+const int OPTIMIZE_VALUE_MIN = 2;       // boundaries are up card values, 11 leaves only the Ace good
+const int OPTIMIZE_VALUE_MAX = 11;
+const int OPTIMIZE_GRID_STEP = 2;       // step of the targets in the first grid, boundaries take every value
+const long long OPTIMIZE_FIRST_ROUNDS = 20000;  // rounds each candidate plays in the first stage of a race
+const int OPTIMIZE_GROWTH = 4;          // each stage plays this many times the rounds of the one before
+const int OPTIMIZE_REFINE_TOP = 4;      // best candidates whose neighbours are tried in a refinement
+const int OPTIMIZE_SHOW = 5;            // candidates listed in the report
+const double OPTIMIZE_PRUNE_CONFIDENCE = 0.999;  // how sure a candidate must be behind before it's dropped
+
+// Structure for one set of the advisor's parameters: hit until the score reaches the target
+// for the kind of up card. Up cards below badValue are fair, below goodValue bad, the rest good.
+struct AdvisorParams {
+
+    int goodTarget;
+    int badTarget;
+    int fairTarget;
+    int badValue;           // lowest bad up card
+    int goodValue;          // lowest good up card, the Ace is always good
+
+    // Constructor for AdvisorParams, the Bicycle strategy's values
+    AdvisorParams() {
+        goodTarget = GOOD_CARD_TARGET;
+        badTarget = BAD_CARD_TARGET;
+        fairTarget = FAIR_CARD_TARGET;
+        badValue = BAD_CARD_VALUE;
+        goodValue = GOOD_CARD_VALUE;
+    }
+};
+
+// Structure for the tallies of one candidate over a stage of a race
+struct RaceTally {
+
+    RunningStats returns;       // round results
+    RunningStats difference;    // minus the stage leader's on the same round
+    RunningStats improvement;   // minus the Bicycle strategy's on the same round
+};
+
+// Per thread slot for a stage of a race, on its own cache line
+struct alignas(64) RaceWorkerResult {
+
+    std::vector<RaceTally> tallies;
+};
+
+// Structure for one candidate of the optimizer
+struct OptimizeCandidate {
+
+    AdvisorParams params;
+    StrategyTable table;
+    RaceTally tally;            // from the last stage it played
+    bool alive;                 // still in the race
+
+    // Constructor for OptimizeCandidate
+    OptimizeCandidate() {
+        table = StrategyTable();
+        alive = true;
+    }
+};
+
+StrategyTable makeAdvisorStrategy(const AdvisorParams& params);
+std::string advisorParamsName(const AdvisorParams& params);
+void raceRounds(Shoe& shoe, Rng& rng, long long rounds, const SimConfig& config,
+                const std::vector<const StrategyTable*>& strategies, int reference, RaceTally* out);
+void raceWorker(SimWorker& worker, long long rounds, const SimConfig& config,
+                const std::vector<const StrategyTable*>& strategies, int reference, RaceWorkerResult* out);
+int runOptimizer(long long rounds, const SimConfig& config, int threads, uint64_t seed);
+
+//////////////////// PART 19 Library /////////////////////////
+// Instrumentation: call counts and time per phase of the hot paths, compiled in with
+// -DBLACKJACK_PROFILE=ON and reported when the program exits. Without it PROFILE_SCOPE
+// expands to nothing and no counter exists.
+
+// Phases the time is attributed to. Scopes nest, a round includes the phases inside it
+// and dealing includes a shuffle when the shoe runs out mid round.
+const int PHASE_ROUND = 0;      // a whole round, blackJack or simulateRound
+const int PHASE_SHUFFLE = 1;    // shuffleDeck and shuffleBatch
+const int PHASE_DEAL = 2;       // drawCard and dealCard
+const int PHASE_TOTALS = 3;     // computeTotals
+const int PHASE_ADVISOR = 4;    // strategy decisions and the game's advice
+const int PHASE_EVALUATE = 5;   // deciding and settling the result of a hand
+const int PHASE_DEALER = 6;     // the dealer drawing to 17
+const int PHASE_RENDER = 7;     // writing a frame to the console
+const int PHASE_INPUT = 8;      // waiting for the player to type
+const int PROFILE_PHASES = 9;
+const std::string PROFILE_PHASE_NAMES[] = {
+    "round", "shuffle", "deal", "totals", "advisor", "evaluate", "dealer", "render", "input"
+};
+
+#ifdef BLACKJACK_PROFILE
+
+// Structure for one thread's counters. Only the owning thread writes them, so nothing is
+// locked or atomic while it runs. They are added to the process totals when the thread exits.
+// No constructor: thread locals start zeroed, and a trivial type is read without a guard.
+struct ProfileCounters {
+
+    uint64_t calls[PROFILE_PHASES];     // scopes of each phase left
+    uint64_t ticks[PROFILE_PHASES];     // cycles spent in each phase
+};
+
+inline thread_local ProfileCounters g_profile;
+void watchProfileThread();
+
+// Reads the cycle counter, or a nanosecond clock on processors without one
+inline uint64_t profileTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// Structure for a scoped timer, charges the time until the end of the scope to its phase
+struct ProfileScope {
+
+    int phase;
+    uint64_t start;
+
+    // Constructor for ProfileScope
+    explicit ProfileScope(int p) {
+        phase = p;
+        start = profileTicks();
+    }
+    ~ProfileScope() {
+        g_profile.ticks[phase] += profileTicks() - start;
+        // The first call of a phase makes sure the thread's counters are added up when it exits
+        if (g_profile.calls[phase]++ == 0) {
+            watchProfileThread();
+        }
+    }
+};
+
+#define PROFILE_JOIN2(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN2(a, b)
+#define PROFILE_SCOPE(phase) blackjack::ProfileScope PROFILE_JOIN(profileScope, __LINE__)(phase)
+#else
+#define PROFILE_SCOPE(phase) ((void)0)
+#endif
+
+
+// CARD HELPERS
+
+// Builds a card from a rank (1-13) and a suit index (0-3)
+inline Card makeCard(int rank, int suit) {
+    Card card;
+    card.code = (unsigned char)(rank | (suit << SUIT_SHIFT));
+    return card;
+}
+
+// Rank of the card, 1 is Ace 13 is King
+inline int cardRank(Card card) {
+    return card.code & RANK_MASK;
+}
+
+// Suit index of the card, 0-3 for Spades, Hearts, Diamonds, Clubs
+inline int cardSuit(Card card) {
+    return (card.code >> SUIT_SHIFT) & SUIT_MASK;
+}
+
+// Display text for a card, e.g. "10H"
+std::string cardName(Card card);
+
+// RULE CHECKS
+
+// A hand can be split when its two cards have the same value, the resplit limit
+// leaves room for another hand, and it didn't come from splitting Aces
+template <typename R>
+bool canSplitHand(const PlayerHands& player, int h, const R& rules) {
+
+    const CardArray& hand = player.hands[h];
+    return hand.usedCards == 2 && player.count < rules.maxHands && !player.splitAces[h] &&
+           HARD_VALUE[cardRank(hand.cards[0])] == HARD_VALUE[cardRank(hand.cards[1])];
+}
+
+// Doubling is allowed on any first two cards, after a split only if the rules allow it
+template <typename R>
+bool canDoubleHand(const PlayerHands& player, int h, const R& rules) {
+
+    return player.hands[h].usedCards == 2 && !player.splitAces[h] &&
+           (player.count == 1 || rules.doubleAfterSplit);
+}
+
+// Late surrender is only offered on the original two card hand, if the rules have it
+template <typename R>
+bool canSurrenderHand(const PlayerHands& player, int h, const R& rules) {
+
+    return rules.surrender && h == 0 && player.count == 1 && player.hands[0].usedCards == 2;
+}
+
+// Whether the dealer draws another card: below 17 always, on a soft 17 only under H17
+template <typename R>
+bool dealerHits(const CardArray& dealerHand, const R& rules) {
+
+    return dealerHand.score < DEALER_MIN ||
+           (rules.hitSoft17 && dealerHand.score == DEALER_MIN && dealerHand.soft);
+}
+
+// Units won or lost by a finished hand with the given bet. A winning natural is paid
+// at the rules' blackjack payout, everything else at even money.
+template <typename R>
+double settleHand(int playerScore, bool playerBlackjack, int dealerScore,
+                  bool dealerBlackjack, double bet, const R& rules) {
+
+    int outcome = evaluateHand(playerScore, playerBlackjack, dealerScore, dealerBlackjack);
+    if (outcome == WIN && playerBlackjack) {
+        return bet * rules.blackjackPays;
+    }
+    return outcome * bet;
+}
+
+// Whether a rules object plays exactly like one of the fixed rule sets
+template <typename F>
+bool matchesRules(const Rules& rules, const F& fixed) {
+
+    return rules.hitSoft17 == fixed.hitSoft17 && rules.blackjackPays == fixed.blackjackPays &&
+           rules.doubleAfterSplit == fixed.doubleAfterSplit && rules.maxHands == fixed.maxHands &&
+           rules.surrender == fixed.surrender;
+}
+
+// BATCH PLAY
+
+// Adds a card to a hand of the batch, totals are only updated by evaluateBatch
+inline void addBatchCard(HandBatch& batch, int lane, Card card) {
+    int row = batch.usedCards[lane]++;
+    batch.value[row][lane] = (unsigned char)HARD_VALUE[cardRank(card)];
+    if (row >= batch.rows) {
+        batch.rows = row + 1;
+    }
+}
+
+// Plays out every pending dealer hand of the batch together: the whole batch is evaluated,
+// each lane that must still draw takes the next card of its own shoe, until no lane draws.
+// Lanes that are done drop out of pending.
+template <typename R>
+void resolveDealers(HandBatch& dealers, Shoe* shoes, Rng* rngs, int lanes, const R& rules) {
+
+    PROFILE_SCOPE(PHASE_DEALER);
+    for (;;) {
+        evaluateBatch(dealers);
+        int drawing = 0;
+        for (int lane = 0; lane < lanes; lane++) {
+            int score = dealers.score[lane];
+            bool hits = score < DEALER_MIN || (rules.hitSoft17 && score == DEALER_MIN && dealers.soft[lane]);
+            dealers.pending[lane] = dealers.pending[lane] && hits;
+            if (dealers.pending[lane]) {
+                addBatchCard(dealers, lane, dealCard(shoes[lane], rngs[lane]));
+                drawing++;
+            }
+        }
+        if (drawing == 0) {
+            return;
+        }
+    }
+}
+
+// ROUND PLAY
+
+// Looks up the strategy's action for hand h. Two card hands look at every option, after that
+// the totals are already known so the decision is one table load.
+template <typename R>
+int decideHand(const PlayerHands& player, int h, int upValue, const StrategyTable& strategy, const R& rules) {
+
+    PROFILE_SCOPE(PHASE_ADVISOR);
+    const CardArray& hand = player.hands[h];
+    if (hand.usedCards == 2) {
+        return strategyDecision(strategy, hand, upValue, canSplitHand(player, h, rules),
+                                canDoubleHand(player, h, rules), canSurrenderHand(player, h, rules));
+    }
+    int action = strategy.action[totalsRow(hand.score, hand.hardTotal)][upValue];
+    if (action > HIT) {
+        action = resolveAction(strategy, action, hand, upValue, false, false);
+    }
+    return action;
+}
+
+// Plays out the player's hands with a strategy table once the dealer has peeked. Splits add
+// hands right after the one being played, and every decision is noted in player.actions.
+// Returns whether a hand is still standing, i.e. whether the dealer has to play.
+// R is Rules or one of the FixedRules sets.
+template <typename R>
+bool playHands(Shoe& shoe, Rng& rng, PlayerHands& player, int upValue,
+               const StrategyTable& strategy, const R& rules) {
+
+    bool dealerPlays = false;
+    for (int h = 0; h < player.count; h++) {
+
+        CardArray& hand = player.hands[h];
+
+        // A hand made by a split gets its second card when its turn comes
+        if (hand.usedCards == 1) {
+            drawCard(shoe, hand, rng);
+        }
+
+        // Split Aces get one card each
+        bool done = player.splitAces[h];
+        while (!done && hand.score < BLACKJACK) {
+
+            int action = decideHand(player, h, upValue, strategy, rules);
+            player.actions[player.actionCount++] = (unsigned char)action;
+            if (action == STAND) {
+                break;
+            }
+            if (action == SURRENDER) {
+                player.surrendered = true;
+                return false;
+            }
+            if (action == SPLIT) {
+                splitHand(player, h);
+                done = player.splitAces[h];
+            }
+            else if (action == DOUBLE) {
+                player.bets[h] *= 2;
+                done = true;
+            }
+            drawCard(shoe, hand, rng);
+        }
+
+        // Dealer only plays out the round if a hand is still standing
+        if (!hand.bust) {
+            dealerPlays = true;
+        }
+    }
+    return dealerPlays;
+}
+
+// Plays one round with no output and returns the player's net result in units of the bet.
+// Hands are reused by the caller and reset here, splits stay inside the PlayerHands storage.
+// Every decision is noted in player.actions for the hand history.
+// R is Rules or one of the FixedRules sets.
+template <typename R>
+double simulateRound(Shoe& shoe, Rng& rng, PlayerHands& player, CardArray& dealerHand,
+                     const StrategyTable& strategy, const R& rules, bool takeInsurance,
+                     const DealerTable* dealerTable) {
+
+    PROFILE_SCOPE(PHASE_ROUND);
+    resetHands(player);
+    clearHand(dealerHand);
+    CardArray& first = player.hands[0];
+
+    // Deal two cards each, alternating like the table does
+    drawCard(shoe, first, rng);
+    drawCard(shoe, dealerHand, rng);
+    drawCard(shoe, first, rng);
+
+    int dealerScore = 0;
+    int upValue = upCardValue(dealerHand);
+    bool dealerBlackjack = false;
+
+    // With an outcome table the dealer gets no more cards, one draw settles the hand:
+    // whether the peek finds a blackjack, and the final total otherwise
+    if (dealerTable != nullptr) {
+        int outcome = sampleDealer(*dealerTable, upValue, false, rng);
+        dealerBlackjack = (outcome == DEALER_BLACKJACK);
+        dealerScore = (outcome == DEALER_BUST) ? BLACKJACK + 1
+                    : dealerBlackjack ? BLACKJACK : DEALER_MIN + outcome;
+    }
+    else {
+        drawCard(shoe, dealerHand, rng);
+        dealerScore = dealerHand.score;
+        dealerBlackjack = dealerHand.blackjack;
+    }
+    double net = 0;
+
+    // Insurance is settled when the dealer peeks
+    if (takeInsurance && upValue == 1) {
+        net = dealerBlackjack ? 2 * INSURANCE_BET : -INSURANCE_BET;
+    }
+
+    // Nobody acts when either side starts with 21
+    if (dealerBlackjack || first.blackjack) {
+        return net + settleHand(first.score, first.blackjack, dealerScore, dealerBlackjack, 1, rules);
+    }
+
+    // Play every hand in turn, then the dealer if a hand is still standing
+    bool dealerPlays = playHands(shoe, rng, player, upValue, strategy, rules);
+    if (player.surrendered) {
+        return net - SURRENDER_LOSS;
+    }
+    if (dealerPlays && dealerTable == nullptr) {
+        PROFILE_SCOPE(PHASE_DEALER);
+        while (dealerHits(dealerHand, rules)) {
+            drawCard(shoe, dealerHand, rng);
+        }
+        dealerScore = dealerHand.score;
+    }
+
+    for (int h = 0; h < player.count; h++) {
+        net += settleHand(player.hands[h].score, false, dealerScore, false, player.bets[h], rules);
+    }
+    return net;
+}
+
+// Plays one round once per strategy, each time from the same shoe position, count and random
+// state (common random numbers), and puts strategy i's net result in units in outcomes[i].
+// The others are undone, the first strategy plays last and the shoe carries on from where it
+// left it. saved holds the shoe's order since its last shuffle, for a round that runs it out.
+template <typename R>
+void playRoundEach(Shoe& shoe, Rng& rng, const StrategyTable* const* strategies, int count,
+                   PlayerHands& player, CardArray& dealerHand, const R& rules, bool takeInsurance,
+                   const DealerTable* dealerTable, std::vector<Card>& saved, double* outcomes) {
+
+    int start = shoe.nextCard;
+    int runningCount = shoe.runningCount;
+    Rng startRng = rng;
+
+    for (int i = count - 1; i >= 0; i--) {
+        shoe.nextCard = start;
+        shoe.runningCount = runningCount;
+        rng = startRng;
+        outcomes[i] = simulateRound(shoe, rng, player, dealerHand, *strategies[i], rules, takeInsurance, dealerTable);
+
+        // A round that runs the shoe out reshuffles it and deals on from the top. No round
+        // takes anywhere near a whole shoe, so only then does it end before where it started.
+        if (shoe.nextCard < start) {
+            if (i > 0) {
+                std::copy(saved.begin(), saved.end(), shoe.cards);
+            }
+            else {
+                std::copy(shoe.cards, shoe.cards + shoe.size, saved.begin());
+            }
+        }
+    }
+}
+
+} // namespace blackjack
+
+#endif // BLACKJACK_H
@@ -0,0 +1,209 @@
+// Strategy comparison: several policies play the same rounds from the same shoes (common
+// random numbers), and the per round differences to the baseline are tallied
+
+#include "blackjack.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+namespace blackjack {
+
+// Adds the tallies of one worker into the running total
+void mergeCompare(CompareResult& total, const CompareResult& part) {
+
+    total.rounds += part.rounds;
+    for (int p = 0; p < MAX_COMPARE_POLICIES; p++) {
+        mergeResults(total.policies[p], part.policies[p]);
+        mergeStats(total.differences[p], part.differences[p]);
+    }
+}
+
+// Plays every round once per policy from the same starting point with playRoundEach. The
+// baseline plays last and moves the shoe on, so it deals exactly the cards it would in a run
+// of its own. Bets come from the count before the round and are the same for all.
+template <typename R>
+static CompareResult compareRoundsWith(Shoe& shoe, Rng& rng, long long rounds, const CompareConfig& config,
+                                       const R& rules) {
+
+    CompareResult result;
+    const SimConfig& sim = config.sim;
+    bool spreadBets = !sim.spread.empty();
+    double outcomes[MAX_COMPARE_POLICIES];
+
+    // Hands live on the stack for the whole run, no allocation per round or per split
+    PlayerHands player;
+    CardArray dealerHand;
+
+    // Order of the cards since the last shuffle, for a round that runs the shoe out
+    vector<Card> saved(shoe.cards, shoe.cards + shoe.size);
+
+    for (long long i = 0; i < rounds; i++) {
+        if (shoe.nextCard >= shoe.cutCard) {
+            shuffleBatch(&shoe, &rng, 1);
+            copy(shoe.cards, shoe.cards + shoe.size, saved.begin());
+        }
+        double bet = spreadBets ? betForCount(sim.spread, trueCount(shoe)) : 1;
+        playRoundEach(shoe, rng, config.strategy, config.policies, player, dealerHand, rules,
+                      sim.takeInsurance, sim.dealerTable, saved, outcomes);
+
+        tallyRound(result.policies[0], bet * outcomes[0], bet);
+        for (int p = 1; p < config.policies; p++) {
+            tallyRound(result.policies[p], bet * outcomes[p], bet);
+            addSample(result.differences[p], bet * (outcomes[p] - outcomes[0]));
+        }
+        result.rounds++;
+    }
+    return result;
+}
+
+// Plays the rounds under the configured rules, the common rule sets run a copy compiled for them
+CompareResult compareRounds(Shoe& shoe, Rng& rng, long long rounds, const CompareConfig& config) {
+
+    const Rules& rules = config.sim.rules;
+    if (matchesRules(rules, FixedRules<false>())) {
+        return compareRoundsWith(shoe, rng, rounds, config, FixedRules<false>());
+    }
+    if (matchesRules(rules, FixedRules<true>())) {
+        return compareRoundsWith(shoe, rng, rounds, config, FixedRules<true>());
+    }
+    return compareRoundsWith(shoe, rng, rounds, config, rules);
+}
+
+// Plays one block of a comparison on the worker's shoe, carrying on from the last block.
+// The results are added into this worker's own slot.
+void compareWorker(SimWorker& worker, long long rounds, const CompareConfig& config, CompareWorkerResult* out) {
+
+    CompareResult part = compareRounds(worker.shoes[0], worker.rngs[0], rounds, config);
+    mergeCompare(out->result, part);
+}
+
+// Entry point for --compare. Splits the rounds across threads like --simulate, each worker
+// deals from the same stream a single policy run would use. With a target precision the rounds
+// are played in blocks until every difference to the baseline is known that well.
+// Prints each policy's EV, then each difference with its standard error.
+int runComparison(long long rounds, const CompareConfig& config, int threads, uint64_t seed) {
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    // One shoe per worker, and the dealer outcome table for the sampled modes
+    CompareConfig run = config;
+    run.sim.shuffleBatch = 1;
+    DealerTable dealerTable;
+    if (run.sim.dealerMode == DEALER_SHOE || run.sim.dealerMode == DEALER_INFINITE) {
+        buildDealerTable(dealerTable, run.sim.rules, run.sim.dealerMode);
+        run.sim.dealerTable = &dealerTable;
+    }
+    const SimConfig& sim = run.sim;
+
+    vector<CompareWorkerResult> slots(threads);
+    vector<SimWorker> states(threads);
+    for (int t = 0; t < threads; t++) {
+        startWorker(states[t], sim, seed, t);
+    }
+
+    CompareResult total;
+    bool reached = false;
+    for (long long played = 0; played < rounds && !reached; ) {
+        // The next block is sized for the difference that still needs the most rounds
+        long long block = rounds;
+        if (sim.precision > 0) {
+            block = PRECISION_MIN_HANDS;
+            for (int p = 1; p < run.policies; p++) {
+                block = max(block, precisionBlock(total.differences[p], sim.precision, sim.confidence));
+            }
+        }
+        long long count = min(block, rounds - played);
+
+        // Give every worker an equal share, the first few take the remainder
+        vector<thread> workers;
+        long long share = count / threads;
+        long long extra = count % threads;
+        for (int t = 0; t < threads; t++) {
+            long long part = share + (t < extra ? 1 : 0);
+            if (t == threads - 1) {
+                compareWorker(states[t], part, run, &slots[t]);
+            }
+            else {
+                workers.push_back(thread(compareWorker, ref(states[t]), part, cref(run), &slots[t]));
+            }
+        }
+        for (size_t t = 0; t < workers.size(); t++) {
+            workers[t].join();
+        }
+        played += count;
+
+        total = CompareResult();
+        for (int t = 0; t < threads; t++) {
+            mergeCompare(total, slots[t].result);
+        }
+        reached = (sim.precision > 0);
+        for (int p = 1; p < run.policies; p++) {
+            reached = reached && confidenceHalfWidth(total.differences[p], sim.confidence) <= sim.precision;
+        }
+    }
+    for (int t = 0; t < threads; t++) {
+        finishWorker(states[t]);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << fixed << setprecision(4);
+    cout << "compare: " << run.policies << " policies, baseline " << run.names[0] << "\n";
+    cout << "seed:    " << seed << "\n";
+    cout << "rng:     " << RNG_NAMES[sim.rngKind] << "\n";
+    cout << "decks:   " << sim.rules.numDecks << " (cut at " << setprecision(0) << sim.penetration * 100 << "%)\n";
+    cout << "rules:   " << rulesName(sim.rules) << "\n";
+    cout << "dealer:  " << DEALER_MODE_NAMES[sim.dealerMode] << "\n";
+    cout << "threads: " << threads << "\n";
+    cout << "rounds:  " << total.rounds << "\n";
+
+    cout << left << setw(32) << "policy" << right << setw(10) << "EV/hand" << setw(9) << "SD/hand"
+         << setw(10) << "avg bet" << "\n";
+    for (int p = 0; p < run.policies; p++) {
+        const SimResult& policy = total.policies[p];
+        double hands = (double)policy.handsPlayed;
+        cout << left << setw(32) << run.names[p] << right << setprecision(4) << showpos << setw(10)
+             << policy.returns.mean << noshowpos << setw(9) << sqrt(sampleVariance(policy.returns))
+             << setprecision(2) << setw(10) << (hands > 0 ? policy.totalWagered / hands : 0.0) << "\n";
+    }
+
+    // Independent runs would need (Va + Vb) / Vdiff times as many rounds for the same error
+    string interval = "+/-" + to_string((int)lround(sim.confidence * 100)) + "%";
+    cout << left << setw(32) << "minus baseline" << right << setw(10) << "diff" << setw(9) << "SE"
+         << setw(10) << interval << setw(8) << "z" << setw(7) << "corr" << setw(9) << "speedup" << "\n";
+    double baseVariance = sampleVariance(total.policies[0].returns);
+    for (int p = 1; p < run.policies; p++) {
+        const RunningStats& diff = total.differences[p];
+        double variance = sampleVariance(total.policies[p].returns);
+        double diffVariance = sampleVariance(diff);
+        double se = standardError(diff);
+        double both = sqrt(variance * baseVariance);
+        cout << left << setw(32) << run.names[p] << right << setprecision(4) << showpos << setw(10) << diff.mean
+             << noshowpos << setprecision(5) << setw(9) << se << setprecision(4) << setw(10)
+             << confidenceHalfWidth(diff, sim.confidence) << setprecision(1) << setw(8) << showpos
+             << (se > 0 ? diff.mean / se : 0.0) << noshowpos << setprecision(2) << setw(7)
+             << (both > 0 ? (variance + baseVariance - diffVariance) / (2 * both) : 0.0);
+        if (diffVariance > 0) {
+            cout << setprecision(1) << setw(8) << (variance + baseVariance) / diffVariance << "x\n";
+        }
+        else {
+            cout << setw(9) << "-" << "\n";
+        }
+    }
+    cout << setprecision(4);
+    if (sim.precision > 0) {
+        cout << "target:  +/-" << sim.precision << (reached ? " reached after " : " not reached in ")
+             << total.rounds << " rounds\n";
+    }
+    cout << setprecision(2);
+    cout << "seconds: " << seconds << "\n";
+    cout << "rounds/s: " << (seconds > 0 ? total.rounds / seconds : 0.0) << endl;
+    return 0;
+}
+
+} // namespace blackjack
@@ -0,0 +1,315 @@
+// Dealer outcome probabilities: exact by shoe composition, infinite deck, and the sampling table
+
+#include "blackjack.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+namespace blackjack {
+
+// Composition of a full shoe of numDecks decks
+ShoeCounts fullShoeCounts(int numDecks) {
+
+    ShoeCounts counts;
+    for (int v = 1; v <= 9; v++) {
+        counts.count[v] = 4 * numDecks;
+    }
+    counts.count[10] = 16 * numDecks;
+    counts.total = MAX_DECK_SIZE * numDecks;
+    return counts;
+}
+
+// Composition of the cards of a shoe that haven't been dealt yet
+ShoeCounts remainingCounts(const Shoe& shoe) {
+
+    ShoeCounts counts;
+    for (int i = shoe.nextCard; i < shoe.size; i++) {
+        counts.count[HARD_VALUE[cardRank(shoe.cards[i])]]++;
+    }
+    counts.total = shoe.size - shoe.nextCard;
+    return counts;
+}
+
+// Takes one card of the given value out of the composition (a card that has been seen)
+void removeValue(ShoeCounts& counts, int value) {
+
+    counts.count[value]--;
+    counts.total--;
+}
+
+// Packs a dealer position into a cache key. Counts of Aces to nines fit in 6 bits
+// (at most 32 in an 8 deck shoe) and tens in 8 bits (at most 128).
+DealerKey dealerKey(const ShoeCounts& counts, int hardTotal, bool hasAce, bool firstDraw, bool peeked) {
+
+    DealerKey key;
+    key.low = 0;
+    for (int v = 1; v <= 9; v++) {
+        key.low |= (uint64_t)counts.count[v] << (6 * (v - 1));
+    }
+    key.high = (uint64_t)counts.count[10]
+             | ((uint64_t)hardTotal << 8)
+             | ((uint64_t)hasAce << 13)
+             | ((uint64_t)firstDraw << 14)
+             | ((uint64_t)peeked << 15);
+    return key;
+}
+
+// Outcome distribution of a dealer hand with the given hard total that draws from counts.
+// Every possible next card is weighted by how many are left, positions already seen come
+// from the cache. counts is changed while recursing and restored before returning.
+// firstDraw is set while the dealer holds only the up card, that is when a blackjack can
+// happen; with peeked the hole card is known not to make one.
+DealerOdds dealerOddsFrom(DealerCache& cache, ShoeCounts& counts, int hardTotal, bool hasAce, bool firstDraw, bool peeked) {
+
+    DealerOdds odds;
+
+    // The dealer stands on 17 or more, a soft 17 only if the cache's rules say so
+    int score = (hasAce && hardTotal + 10 <= BLACKJACK) ? hardTotal + 10 : hardTotal;
+    if (score > BLACKJACK) {
+        odds.p[DEALER_BUST] = 1;
+        return odds;
+    }
+    bool softHit = cache.hitSoft17 && score == DEALER_MIN && score != hardTotal;
+    if (score >= DEALER_MIN && !softHit) {
+        odds.p[score - DEALER_MIN] = 1;
+        return odds;
+    }
+    // Only a heavily depleted composition runs out, count it as the lowest standing total
+    if (counts.total == 0) {
+        odds.p[0] = 1;
+        return odds;
+    }
+
+    DealerKey key = dealerKey(counts, hardTotal, hasAce, firstDraw, peeked);
+    unordered_map<DealerKey, DealerOdds, DealerKeyHash>::const_iterator found = cache.table.find(key);
+    if (found != cache.table.end()) {
+        cache.hits++;
+        return found->second;
+    }
+    cache.misses++;
+
+    // A peeked hole card can't be the one that completes a blackjack
+    int skipValue = 0;
+    if (firstDraw && peeked) {
+        skipValue = (hardTotal == 1) ? 10 : (hardTotal == 10 ? 1 : 0);
+    }
+    int drawable = counts.total - (skipValue ? counts.count[skipValue] : 0);
+
+    for (int v = 1; v <= 10; v++) {
+        if (counts.count[v] == 0 || v == skipValue) {
+            continue;
+        }
+        double weight = (double)counts.count[v] / drawable;
+
+        // Up card plus this hole card is a natural
+        if (firstDraw && ((hardTotal == 1 && v == 10) || (hardTotal == 10 && v == 1))) {
+            odds.p[DEALER_BLACKJACK] += weight;
+            continue;
+        }
+
+        removeValue(counts, v);
+        DealerOdds next = dealerOddsFrom(cache, counts, hardTotal + v, hasAce || v == 1, false, false);
+        counts.count[v]++;
+        counts.total++;
+
+        for (int i = 0; i < DEALER_OUTCOMES; i++) {
+            odds.p[i] += weight * next.p[i];
+        }
+    }
+
+    if (cache.table.size() >= cache.maxEntries) {
+        cache.table.clear();
+    }
+    cache.table[key] = odds;
+    return odds;
+}
+
+// Dealer outcome distribution for an up card (1 is an Ace) when the unseen cards are counts.
+// counts must already exclude the up card and every other card that has been seen.
+// With peeked the distribution is conditioned on the dealer not having blackjack.
+DealerOdds dealerOdds(DealerCache& cache, const ShoeCounts& counts, int upValue, bool peeked) {
+
+    ShoeCounts work = counts;
+    return dealerOddsFrom(cache, work, upValue, upValue == 1, true, peeked);
+}
+
+// Entry point for --dealer-odds. Prints the exact dealer outcome distribution for every
+// up card from a full shoe, with and without the peek, next to the advisor's up card class.
+int runDealerOdds(const Rules& rules) {
+
+    int numDecks = rules.numDecks;
+    DealerCache cache;
+    cache.hitSoft17 = rules.hitSoft17;
+    const string CLASS_NAMES[] = { "bad", "fair", "good" };
+
+    cout << fixed << setprecision(4);
+    for (int peek = 0; peek <= 1; peek++) {
+        cout << "dealer outcomes, " << numDecks << " deck" << (numDecks > 1 ? "s" : "")
+             << (rules.hitSoft17 ? ", hits soft 17" : ", stands on soft 17")
+             << (peek ? ", no blackjack (peeked)" : "") << "\n";
+        cout << "up  class      17      18      19      20      21      BJ    bust\n";
+
+        double classBust[3] = { 0, 0, 0 };
+        int classCards[3] = { 0, 0, 0 };
+        for (int column = 0; column < 10; column++) {
+            int up = (column == 9) ? 1 : column + 2;
+            ShoeCounts counts = fullShoeCounts(numDecks);
+            removeValue(counts, up);
+            DealerOdds odds = dealerOdds(cache, counts, up, peek == 1);
+
+            int upClass = upCardClass(up);
+            // Tens are four of the thirteen ranks
+            int weight = (up == 10) ? 4 : 1;
+            classBust[upClass + 1] += weight * odds.p[DEALER_BUST];
+            classCards[upClass + 1] += weight;
+
+            cout << left << setw(4) << (up == 1 ? string("A") : to_string(up)) << setw(6) << CLASS_NAMES[upClass + 1] << right;
+            for (int i = 0; i < DEALER_OUTCOMES; i++) {
+                cout << setw(8) << odds.p[i];
+            }
+            cout << "\n";
+        }
+        cout << "bust rate by class: ";
+        for (int c = 0; c < 3; c++) {
+            cout << CLASS_NAMES[c] << " " << classBust[c] / classCards[c] << (c < 2 ? ", " : "\n\n");
+        }
+    }
+
+    // Timing: cold queries for random partly dealt shoes, then the same queries again from the cache
+    Rng rng;
+    seedRng(rng, RNG_XOSHIRO, 12345, 0);
+    Shoe shoe;
+    getNewDeck(shoe, numDecks, 1.0);
+    const int QUERIES = 2000;
+    vector<ShoeCounts> queries;
+    vector<int> ups;
+    for (int q = 0; q < QUERIES; q++) {
+        shuffleDeck(shoe, rng);
+        shoe.nextCard = randomBelow(rng, shoe.size / 2);
+        ShoeCounts counts = remainingCounts(shoe);
+        int up = HARD_VALUE[cardRank(shoe.cards[shoe.nextCard])];
+        removeValue(counts, up);
+        queries.push_back(counts);
+        ups.push_back(up);
+    }
+    cache.table.clear();
+    cache.hits = 0;
+    cache.misses = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        double sum = 0;
+        for (int q = 0; q < QUERIES; q++) {
+            sum += dealerOdds(cache, queries[q], ups[q], false).p[DEALER_BUST];
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << (pass == 0 ? "cold" : "warm") << " queries: " << QUERIES << " in " << setprecision(3)
+             << seconds * 1000 << " ms (" << setprecision(0) << QUERIES / seconds << "/s), mean bust "
+             << setprecision(4) << sum / QUERIES << "\n";
+    }
+    cout << "cache entries: " << cache.table.size() << ", hits " << cache.hits << ", misses " << cache.misses << endl;
+
+    freeShoe(shoe);
+    return 0;
+}
+
+// Dealer outcome distribution for an infinite deck: every card value is drawn with its
+// share of a single deck, whatever has been dealt. Same rules and arguments as dealerOddsFrom.
+DealerOdds infiniteDealerOdds(int hardTotal, bool hasAce, bool firstDraw, bool peeked, bool hitSoft17) {
+
+    DealerOdds odds;
+
+    int score = (hasAce && hardTotal + 10 <= BLACKJACK) ? hardTotal + 10 : hardTotal;
+    if (score > BLACKJACK) {
+        odds.p[DEALER_BUST] = 1;
+        return odds;
+    }
+    bool softHit = hitSoft17 && score == DEALER_MIN && score != hardTotal;
+    if (score >= DEALER_MIN && !softHit) {
+        odds.p[score - DEALER_MIN] = 1;
+        return odds;
+    }
+
+    // A peeked hole card can't be the one that completes a blackjack
+    int skipValue = 0;
+    if (firstDraw && peeked) {
+        skipValue = (hardTotal == 1) ? 10 : (hardTotal == 10 ? 1 : 0);
+    }
+    double drawable = MAX_CARDS_IN_SUIT - (skipValue == 10 ? 4 : (skipValue ? 1 : 0));
+
+    for (int v = 1; v <= 10; v++) {
+        if (v == skipValue) {
+            continue;
+        }
+        double weight = ((v == 10) ? 4 : 1) / drawable;
+
+        // Up card plus this hole card is a natural
+        if (firstDraw && ((hardTotal == 1 && v == 10) || (hardTotal == 10 && v == 1))) {
+            odds.p[DEALER_BLACKJACK] += weight;
+            continue;
+        }
+
+        DealerOdds next = infiniteDealerOdds(hardTotal + v, hasAce || v == 1, false, false, hitSoft17);
+        for (int i = 0; i < DEALER_OUTCOMES; i++) {
+            odds.p[i] += weight * next.p[i];
+        }
+    }
+    return odds;
+}
+
+// Fills the table the simulator samples the dealer from, for every up card with and without
+// the peek. DEALER_SHOE uses a full shoe of the rules' decks less the up card, DEALER_INFINITE
+// an infinite deck.
+void buildDealerTable(DealerTable& table, const Rules& rules, int mode) {
+
+    DealerCache cache;
+    cache.hitSoft17 = rules.hitSoft17;
+    for (int peek = 0; peek <= 1; peek++) {
+        for (int up = 1; up <= 10; up++) {
+            DealerOdds odds;
+            if (mode == DEALER_INFINITE) {
+                odds = infiniteDealerOdds(up, up == 1, true, peek == 1, rules.hitSoft17);
+            }
+            else {
+                ShoeCounts counts = fullShoeCounts(rules.numDecks);
+                removeValue(counts, up);
+                odds = dealerOdds(cache, counts, up, peek == 1);
+            }
+            double sum = 0;
+            for (int i = 0; i < DEALER_OUTCOMES; i++) {
+                sum += odds.p[i];
+                table.cumulative[peek][up][i] = sum;
+            }
+            // Rounding must not leave a gap a draw could fall through
+            table.cumulative[peek][up][DEALER_OUTCOMES - 1] = 1.0;
+        }
+    }
+}
+
+// Draws the dealer's outcome for an up card: 0-4 for 17-21, DEALER_BLACKJACK or DEALER_BUST
+int sampleDealer(const DealerTable& table, int upValue, bool peeked, Rng& rng) {
+
+    // 53 random bits give a uniform double in [0, 1)
+    double u = (nextRandom(rng) >> 11) * (1.0 / 9007199254740992.0);
+    const double* cumulative = table.cumulative[peeked][upValue];
+    int outcome = 0;
+    while (u >= cumulative[outcome]) {
+        outcome++;
+    }
+    return outcome;
+}
+
+// Looks up a dealer mode by the name given on the command line, -1 if unknown
+int dealerModeByName(const string& name) {
+
+    for (int mode = DEALER_EXACT; mode <= DEALER_BATCH; mode++) {
+        if (name == DEALER_MODE_NAMES[mode]) {
+            return mode;
+        }
+    }
+    return -1;
+}
+
+} // namespace blackjack
@@ -0,0 +1,777 @@
+/*
+Advisor gives advice on when the player should hit or stand based off Bicycle Strategy.
+https://bicyclecards.com/how-to-play/blackjack/
+
+I found this method to be more efficient than probability/percentage which makes the player calculate
+further and think about what to do, Instead this way they have an visual cues on when to hit or stand.
+
+When the dealer's visible card is a 7, 8, 9, facecard, or an ace, it's considered a good card.
+The player's best shot at winning is to have a score of at least 17.
+
+When the dealer's visible card is a 4, 5, or 6, it's considered a bad card.
+The player should aim for a score of 12 or higher. Put's the pressure on dealer to bust while
+trying to reach the minimum required dealer score of 17.
+
+When the dealer's visible card is a 2 or 3, it's considered a fair card.
+The player should aim for a score of 13 or higher.
+
+This method yields the best results while presenting the most straightforward advice.
+Simulations with the above mention VS. the percentage calculator method yield accuracy within 1%.
+*/
+
+// Interactive console game: the table, the prompts and the advisor
+
+#include "blackjack.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+using namespace std;
+using namespace blackjack;
+
+// Try to enable ANSI processing and UTF-8 output on Windows consoles.
+// Returns whether Unicode suit symbols can be shown. On POSIX assume they can.
+bool enableAnsi() {
+#ifdef _WIN32
+    HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
+    if (hOut == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    // Try set console to UTF-8 output code page
+    // (if that fails, fall back to ASCII suits)
+    bool unicode = SetConsoleOutputCP(CP_UTF8) != 0;
+
+    // Try to enable virtual terminal processing (ANSI colors)
+    DWORD dwMode = 0;
+    if (!GetConsoleMode(hOut, &dwMode)) {
+        return false;
+    }
+    if (!(dwMode & ENABLE_VIRTUAL_TERMINAL_PROCESSING)) {
+        if (!SetConsoleMode(hOut, dwMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING)) {
+            // If we can't enable ANSI, still continue but colors may not work
+        }
+    }
+    return unicode;
+#else
+    // On Linux/macOS terminals Unicode and ANSI are normally available
+    return true;
+#endif
+}
+
+// Console output of the game, written a frame at a time (flushed before every prompt)
+Renderer g_out;
+
+// Random number generator for the interactive game (simulations bring their own)
+Rng g_rng;
+
+// Strategy used by the interactive advisor, Bicycle unless --strategy loads another one
+const StrategyTable* g_strategy = &BICYCLE_STRATEGY;
+
+// Global flag: whether the advisor also prints the exact EV of each action (--advisor-ev)
+bool g_advisor_ev = false;
+
+// Rules of the interactive table, set from the command line
+Rules g_rules;
+
+// Global flag: whether the game shows the running and true count before each round (--show-count)
+bool g_show_count = false;
+
+
+// Function prototypes
+
+//////////////////// PART 1 Library /////////////////////////
+void printDeck(const Shoe& shoe);
+
+//////////////////// PART 2 Library /////////////////////////
+double blackJack(Shoe& shoe);
+void deal(Shoe& shoe, CardArray& hand);
+int chooseAction(bool canDouble, bool canSplit, bool canSurrender);
+bool askYesNo(const string& question);
+bool readInput(string& userInput);
+int reportScore(const CardArray& hand, bool& softUsed);
+
+//////////////////// PART 3 Library /////////////////////////
+void playGames(Shoe& shoe);
+
+//////////////////// PART 5 Library /////////////////////////
+void initialAdvisor(CardArray& dealerHand, int playerScore, int dealerScore);
+void advisor(CardArray& playerHand, CardArray& dealerHand, int playerScore, int dealerScore, bool bust,
+             bool canSplit, bool canDouble, bool canSurrender);
+
+//////////////////// PART 10 Library /////////////////////////
+void evAdvisor(const Shoe& shoe, const CardArray& playerHand, const CardArray& dealerHand,
+               bool canSplit, bool canDouble, bool canSurrender);
+
+
+// Prints 52 unsorted cards, then prints shuffled deck and plays blackjack.
+// --protocol plays tables for a bot instead, one command per line on stdin.
+// --strategy FILE replaces the advisor's advice with a strategy table from a file.
+// Headless simulation and the odds tables are in the simulator (blackjack_sim).
+int main(int argc, char* argv[])
+{
+    // Seed from the clock unless a seed is given, so games can be replayed
+    uint64_t seed = (uint64_t)time(0);
+    int rngKind = RNG_XOSHIRO;
+
+    string policyName = "bicycle";
+    Rules rules;
+    double penetration = DEFAULT_PENETRATION;
+    string strategyFile;
+    int countSystem = COUNT_HILO;
+    string renderName = "auto";
+    bool protocol = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string error;
+        if (readRulesOption(argc, argv, i, rules, error)) {
+            if (!error.empty()) {
+                cerr << error << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--policy" && i + 1 < argc) {
+            policyName = argv[++i];
+        }
+        else if (arg == "--seed" && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--penetration" && i + 1 < argc) {
+            penetration = atof(argv[++i]);
+        }
+        else if (arg == "--rng" && i + 1 < argc) {
+            rngKind = rngByName(argv[++i]);
+        }
+        else if (arg == "--strategy" && i + 1 < argc) {
+            strategyFile = argv[++i];
+        }
+        else if (arg == "--advisor-ev") {
+            g_advisor_ev = true;
+        }
+        else if (arg == "--count" && i + 1 < argc) {
+            countSystem = countByName(argv[++i]);
+        }
+        else if (arg == "--show-count") {
+            g_show_count = true;
+        }
+        else if (arg == "--render" && i + 1 < argc) {
+            renderName = argv[++i];
+        }
+        else if (arg == "--protocol") {
+            protocol = true;
+        }
+        else {
+            cerr << "Usage: " << argv[0] << " [--policy bicycle|dealer|neverbust] [--strategy FILE]"
+                 << " [--advisor-ev] [--seed S] [--rng xoshiro|pcg|splitmix] [--penetration 0-1]"
+                 << rulesUsage() << " [--count hilo|ko|omega2] [--show-count]"
+                 << " [--render auto|null|plain|ansi|unicode] [--protocol]" << endl
+                 << "Simulations, strategy charts and odds tables are run with blackjack_sim" << endl;
+            return 1;
+        }
+    }
+    if (countSystem < 0) {
+        cerr << "Unknown counting system (use hilo, ko or omega2)" << endl;
+        return 1;
+    }
+    if (rngKind < 0) {
+        cerr << "Unknown random number generator (use xoshiro, pcg or splitmix)" << endl;
+        return 1;
+    }
+    int renderMode = (renderName == "auto") ? RENDER_UNICODE : renderModeByName(renderName);
+    if (renderMode < 0) {
+        cerr << "Unknown render mode (use auto, null, plain, ansi or unicode)" << endl;
+        return 1;
+    }
+    string error;
+    if (!checkRules(rules, error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    if (penetration <= 0 || penetration > 1) {
+        cerr << "Penetration must be above 0 and at most 1" << endl;
+        return 1;
+    }
+
+    // Strategy for the advisor, a file overrides the named policy
+    StrategyTable loaded;
+    const StrategyTable* strategy = selectStrategy(policyName, strategyFile, loaded, error);
+    if (strategy == nullptr) {
+        cerr << error << endl;
+        return 1;
+    }
+    g_strategy = strategy;
+    g_rules = rules;
+
+    // Bots drive any number of tables over stdin and stdout, answers are JSON lines
+    if (protocol) {
+        ProtocolSession session;
+        session.rules = rules;
+        session.penetration = penetration;
+        session.rngKind = rngKind;
+        session.seed = seed;
+        session.countSystem = countSystem;
+        session.strategy = strategy;
+        setRenderMode(g_out, RENDER_PLAIN);
+        // Unsynced input is buffered, so the protocol can see when a bot sent lines ahead
+        ios::sync_with_stdio(false);
+        return runProtocol(session, cin, g_out);
+    }
+
+    // Interactive game uses stream 0 of the seed
+    seedRng(g_rng, rngKind, seed, 0);
+
+    // enable color output where supported, auto falls back to ASCII suits without UTF-8
+    if (renderMode == RENDER_ANSI || renderMode == RENDER_UNICODE) {
+        if (!enableAnsi() && renderName == "auto") {
+            renderMode = RENDER_ANSI;
+        }
+    }
+    setRenderMode(g_out, renderMode);
+
+    // colorful banner
+    g_out << STYLE_BOLD << STYLE_BLUE;
+    g_out << "================================\n";
+    g_out << "          BLACKJACK\n";
+    g_out << "================================\n";
+    g_out << STYLE_NORMAL;
+    // Creates a struct variable for the shoe
+    Shoe shoe;
+    // Generates a shoe of 52 cards per deck
+    getNewDeck(shoe, rules.numDecks, penetration);
+    setCountSystem(shoe, countSystem);
+    // Prints the unshuffled shoe
+    printDeck(shoe);
+
+    g_out << "\nShuffled\n";
+    // Shuffles the shoe
+    shuffleDeck(shoe, g_rng);
+    // Now prints the newly shuffled shoe
+    printDeck(shoe);
+    g_out << '\n';
+
+    // Function for playing as many games as user desires
+    playGames(shoe);
+    // Delete the shoe created in dynamic memory
+    freeShoe(shoe);
+    flushFrame(g_out);
+
+    return 0;
+}
+
+// Prints the cards of the shoe
+void printDeck(const Shoe& shoe) {
+
+    // Loops through the entire shoe, printing each card right aligned
+    for (int i = 0; i < shoe.size; i++) {
+        g_out << g_out.nameGlyph[shoe.cards[i].code];
+        // Prints 13 cards per line displayed
+        if ((i + 1) % MAX_CARDS_IN_SUIT == 0) {
+            g_out << '\n';
+        }
+    }
+}
+
+// Allows the user to play mutliple games of BlackJack and gives results
+void playGames(Shoe& shoe) {
+
+    // Initialize variables to record stats
+    int wins = 0, losses = 0, draws = 0;
+
+    // Initialize variable for calling blackjack, the net result of a round in units
+    double result = 0;
+    // Sum of the round results in units
+    double net = 0;
+    // Running mean and variance of the round results
+    RunningStats rounds;
+    // Track the number for games played
+    int gamesPlayed = 0;
+    // String for taking in user input for decisions
+    string userInput;
+
+    // Display black jack and option
+    g_out << "BLACKJACK\n---------\n";
+    g_out << "\nDo you want to play a hand of blackjack (y to play)? ";
+    flushFrame(g_out);
+    readInput(userInput);
+
+    // If the user uses the right key, continue
+    while (userInput == "Y" || userInput == "y") {
+        //Play game
+        result = blackJack(shoe);
+        gamesPlayed++;
+        net += result;
+        addSample(rounds, result);
+
+        // Track results, a round counts as won or lost by its net result
+        if (result > 0) {
+            wins++;
+        }
+        else if (result == 0) {
+            draws++;
+        }
+        else {
+            losses++;
+        }
+
+        // Ask if they want to play again
+        g_out << "\n_____________________________\n";
+        g_out << "\nDo you want to play another hand (y to play)? ";
+        flushFrame(g_out);
+        readInput(userInput);
+    }
+
+    // Print out the final results if they played games
+    if (gamesPlayed > 0) {
+        g_out << "\n\nThanks for playing, you played " << gamesPlayed << " games and your record was \n";
+        g_out << "  Wins: " << wins << '\n';
+        g_out << "Losses: " << losses << '\n';
+        g_out << " Draws: " << draws << '\n';
+        g_out << "   Net: " << (net >= 0 ? "+" : "") << net << " units\n";
+        // An interval needs at least two rounds
+        if (gamesPlayed > 1) {
+            g_out << "    EV: " << fixedNumber(rounds.mean, 3, true) << " +/- "
+                  << fixedNumber(confidenceHalfWidth(rounds, DEFAULT_CONFIDENCE), 3) << " units per hand ("
+                  << (int)(DEFAULT_CONFIDENCE * 100) << "% confidence)\n";
+        }
+    }
+    // Print goodbye if they didn't play any games
+    else if (gamesPlayed == 0) {
+        g_out << "Goodbye!\n";
+    }
+}
+
+// BlackJack game function, plays one round and returns the player's net result in units
+// of the bet. Splits, doubles, insurance and late surrender are offered when allowed.
+double blackJack(Shoe& shoe) {
+
+    PROFILE_SCOPE(PHASE_ROUND);
+    double net = 0;         // what the round won or lost in units of the bet
+    int dealerScore = 0;    // Initialize variable for storing dealer score
+
+    // Player hands and dealer hand live on the stack, splitting never allocates
+    PlayerHands player;
+    CardArray dealerHand;
+    CardArray& playerHand = player.hands[0];
+
+    // Shuffle before the round if the cut card came out last round
+    if (reshuffleAtCutCard(shoe, g_rng)) {
+        g_out << "\n//////New shuffled shoe//////\n";
+    }
+
+    // Count of the cards seen so far, before any of this round's cards
+    if (g_show_count) {
+        g_out << "\nRunning count: " << shoe.runningCount << ", true count: "
+              << fixedNumber(trueCount(shoe), 1) << " (" << COUNT_NAMES[shoe.countSystem] << ")\n";
+    }
+
+    // Deal first card
+    g_out << "\nDeal First Card \n---------------\n";
+    deal(shoe, playerHand);
+    deal(shoe, dealerHand);
+
+    // Print first card, both cards visible
+    g_out << "+Player+: ";
+    renderHand(g_out, playerHand, VISIBLE);
+    g_out << "\n*Dealer*: ";
+    renderHand(g_out, dealerHand, VISIBLE);
+
+    // Deal second card
+    g_out << "\n\nDeal second Card \n----------------\n";
+    deal(shoe, playerHand);
+    deal(shoe, dealerHand);
+
+    // Print second card, player visible, dealer hidden
+    g_out << "+Player+: ";
+    renderHand(g_out, playerHand, VISIBLE);
+    g_out << "\n*Dealer*: ";
+    renderHand(g_out, dealerHand, HIDDEN);
+
+    // Calculate player and dealer score (use soft/hard totals) and print the player's totals
+    bool softUsed = false;
+    g_out << '\n';
+    int playerScore = reportScore(playerHand, softUsed);
+    dealerScore = scoreOf(dealerHand);
+
+    // Give initial feedback regarding dealers upcard
+    initialAdvisor(dealerHand, playerScore, dealerScore);
+
+    // Offer insurance when the dealer shows an Ace
+    if (upCardValue(dealerHand) == 1 &&
+        askYesNo("\n\nThe dealer shows an Ace. Take insurance for half your bet (y/n)? ")) {
+        player.insurance = INSURANCE_BET;
+    }
+
+    // The dealer peeks, a blackjack ends the round before the player acts
+    if (dealerScore == BLACKJACK) {
+        g_out << "\n*Dealer*: ";
+        renderHand(g_out, dealerHand, VISIBLE);
+        // Double BlackJack - rare scenario. If Both hit 21 right off the bat
+        if (playerScore == BLACKJACK) {
+            g_out << "\n\nBlackJack TIE!!! ";
+        }
+        else {
+            g_out << "\n\nDealer hit blackjack, You lose.";
+        }
+        if (player.insurance > 0) {
+            g_out << "\nInsurance pays 2 to 1.";
+        }
+        return 2 * player.insurance +
+               settleHand(playerScore, playerScore == BLACKJACK, dealerScore, true, 1, g_rules);
+    }
+    if (player.insurance > 0) {
+        g_out << "\nDealer doesn't have blackjack, insurance is lost.";
+        net -= player.insurance;
+    }
+
+    // If user hits blackjack with 2 cards
+    if (playerScore == BLACKJACK) {
+        g_out << "\n*Dealer*: ";
+        renderHand(g_out, dealerHand, VISIBLE);
+        g_out << "\n\nPlayer hit BlackJack, You win! ";
+        return net + settleHand(playerScore, true, dealerScore, false, 1, g_rules);
+    }
+
+    // Play every hand in turn, splits add hands right after the one being played
+    int scores[MAX_SPLIT_HANDS];
+    bool dealerPlays = false;
+    for (int h = 0; h < player.count; h++) {
+
+        CardArray& hand = player.hands[h];
+        if (player.count > 1) {
+            g_out << "\n\nHand " << h + 1 << " of " << player.count << "\n---------\n";
+        }
+
+        // A hand made by a split gets its second card when its turn comes
+        if (hand.usedCards == 1) {
+            deal(shoe, hand);
+            g_out << "+Player+: ";
+            renderHand(g_out, hand, VISIBLE);
+            g_out << '\n';
+            softUsed = false;
+            scores[h] = reportScore(hand, softUsed);
+        }
+        else {
+            scores[h] = playerScore;
+        }
+
+        // Split Aces get one card each
+        bool done = player.splitAces[h];
+        if (done) {
+            g_out << "\t(Split Aces get one card each)\n";
+        }
+
+        while (!done && scores[h] < BLACKJACK) {
+
+            bool canSplit = canSplitHand(player, h, g_rules);
+            bool canDouble = canDoubleHand(player, h, g_rules);
+            bool canSurrender = canSurrenderHand(player, h, g_rules);
+
+            // Call advisor function and update as necessary
+            advisor(hand, dealerHand, scores[h], dealerScore, false, canSplit, canDouble, canSurrender);
+            if (g_advisor_ev) {
+                evAdvisor(shoe, hand, dealerHand, canSplit, canDouble, canSurrender);
+            }
+
+            // Ask what the user wants to do with this hand
+            g_out << "\n\nDealing to player: \n-----------------";
+            int action = chooseAction(canDouble, canSplit, canSurrender);
+
+            if (action == STAND) {
+                break;
+            }
+            if (action == SURRENDER) {
+                player.surrendered = true;
+                break;
+            }
+            if (action == SPLIT) {
+                splitHand(player, h);
+                g_out << "\nSplitting into " << player.count << " hands.\n";
+                deal(shoe, hand);
+                softUsed = false;
+                done = player.splitAces[h];
+                if (done) {
+                    g_out << "+Player+: ";
+                    renderHand(g_out, hand, VISIBLE);
+                    g_out << '\n';
+                    scores[h] = reportScore(hand, softUsed);
+                    g_out << "\t(Split Aces get one card each)\n";
+                    break;
+                }
+            }
+            else {
+                // Hit or double: one more card, a double doubles the bet and ends the hand
+                if (action == DOUBLE) {
+                    player.bets[h] *= 2;
+                    g_out << "\nDoubled down, one card only.";
+                    done = true;
+                }
+                deal(shoe, hand);
+            }
+            g_out << "\n+Player+: ";
+            renderHand(g_out, hand, VISIBLE);
+            g_out << '\n';
+            scores[h] = reportScore(hand, softUsed);
+        }
+
+        // Dealer only plays out the round if a hand is still standing
+        if (!player.surrendered && scores[h] <= BLACKJACK) {
+            dealerPlays = true;
+        }
+    }
+
+    // If user stands and dealer has less than 17 (or a soft 17 under H17)
+    if (dealerPlays && dealerHits(dealerHand, g_rules)) {
+        g_out << "\nDealing to dealer: \n-----------------\n";
+        g_out << "*Dealer*: ";
+        renderHand(g_out, dealerHand, VISIBLE);
+
+        // Keep dealing to dealer till they reach the score they stand on
+        PROFILE_SCOPE(PHASE_DEALER);
+        while (dealerHits(dealerHand, g_rules)) {
+            deal(shoe, dealerHand);
+            g_out << "\n*Dealer*: ";
+            renderHand(g_out, dealerHand, VISIBLE);
+            dealerScore = scoreOf(dealerHand);
+        }
+    }
+    // Reveal dealer's cards if they didn't draw
+    else {
+        g_out << "\n*Dealer*: ";
+        renderHand(g_out, dealerHand, VISIBLE);
+    }
+
+    // RESULTS
+
+    // Surrender gives back half the bet
+    if (player.surrendered) {
+        g_out << "\n\nYou surrendered, half your bet is returned.";
+        return net - SURRENDER_LOSS;
+    }
+
+    for (int h = 0; h < player.count; h++) {
+
+        if (player.count > 1) {
+            g_out << "\n\nHand " << h + 1 << ":";
+        }
+        else {
+            g_out << '\n';
+        }
+
+        int outcome = evaluateHand(scores[h], false, dealerScore, false);
+        net += settleHand(scores[h], false, dealerScore, false, player.bets[h], g_rules);
+
+        // Tell user they lost if they bust
+        if (scores[h] > BLACKJACK) {
+            g_out << "\nBust! You lose.";
+            continue;
+        }
+        g_out << "\nplayer score: " << scores[h];
+        g_out << ", dealer score: " << dealerScore;
+
+        // If dealer busts, user wins
+        if (dealerScore > BLACKJACK) {
+            g_out << "\nDealer is bust, you win.";
+        }
+        else if (outcome == WIN) {
+            g_out << "\nYou win.";
+        }
+        else if (outcome == LOSE) {
+            g_out << "\nYou lose";
+        }
+        else {
+            g_out << "\nGame is tied.";
+        }
+    }
+    return net;
+}
+
+// Takes the shoe, deals shuffled cards one by one to both player
+// and the dealer
+void deal(Shoe& shoe, CardArray& hand) {
+
+    // Let the user know when the shoe ran out mid round and was reshuffled
+    if (drawCard(shoe, hand, g_rng)) {
+        g_out << "\n//////New shuffled shoe//////\n\n";
+    }
+}
+
+// Asks the user what to do with a hand. Only the actions allowed right now are offered.
+// Returns STAND, HIT, DOUBLE, SPLIT or SURRENDER.
+int chooseAction(bool canDouble, bool canSplit, bool canSurrender) {
+
+    // Build the prompt from the allowed actions
+    string prompt = "Enter h to hit or s to stand";
+    if (canDouble) prompt += ", d to double";
+    if (canSplit) prompt += ", p to split";
+    if (canSurrender) prompt += ", r to surrender";
+    prompt += ": ";
+
+    // Initialize string for user Input
+    string userInput;
+
+    // If the user input isn't one of the offered letters,
+    // Show error and ask for input again
+    g_out << '\n' << prompt;
+    flushFrame(g_out);
+    while (readInput(userInput)) {
+        if (userInput == "h" || userInput == "H") return HIT;
+        if (userInput == "s" || userInput == "S") return STAND;
+        if (canDouble && (userInput == "d" || userInput == "D")) return DOUBLE;
+        if (canSplit && (userInput == "p" || userInput == "P")) return SPLIT;
+        if (canSurrender && (userInput == "r" || userInput == "R")) return SURRENDER;
+        g_out << "Incorrect input, " << prompt;
+        flushFrame(g_out);
+    }
+    // Out of input, stand
+    return STAND;
+}
+
+// Reads the player's next word, the wait counts as input time when profiling.
+// Returns false once the input has run out.
+bool readInput(string& userInput) {
+
+    PROFILE_SCOPE(PHASE_INPUT);
+    return (bool)(cin >> userInput);
+}
+
+// Asks a yes or no question, anything but y or Y is a no
+bool askYesNo(const string& question) {
+
+    string userInput;
+    g_out << question;
+    flushFrame(g_out);
+    readInput(userInput);
+    return (userInput == "y" || userInput == "Y");
+}
+
+// Prints the totals and current score of a player hand and returns the score.
+// softUsed tracks whether an Ace was counted as 11 so its revaluation can be noted.
+int reportScore(const CardArray& hand, bool& softUsed) {
+
+    int soft = 0, hard = 0, aces = 0;
+    computeTotals(hand, soft, hard, aces);
+    int score = (soft <= BLACKJACK) ? soft : hard;
+
+    // Detect ace revaluation (soft -> hard)
+    bool newSoftUsed = (aces > 0 && soft <= BLACKJACK && soft != hard);
+    if (softUsed && !newSoftUsed) {
+        g_out << "\t(Ace counted as 1 to avoid bust)\n";
+    }
+
+    // Print totals if an Ace is present
+    if (aces > 0) {
+        g_out << "\tTotals: " << STYLE_BOLD << soft << STYLE_NORMAL << " (soft), " << hard << " (hard)";
+        if (newSoftUsed && !softUsed) {
+            g_out << "  (Ace counted as 11)";
+        }
+        g_out << '\n';
+    }
+    // Always print current (chosen) score for player
+    g_out << "\tCurrent score: " << STYLE_BOLD << score << STYLE_NORMAL << '\n';
+
+    softUsed = newSoftUsed;
+    return score;
+}
+
+// Advisor for giving advice to the player, the advice is looked up in the strategy table
+void advisor(CardArray& playerHand, CardArray& dealerHand, int playerScore, int dealerScore, bool bust,
+             bool canSplit, bool canDouble, bool canSurrender) {
+
+    PROFILE_SCOPE(PHASE_ADVISOR);
+    // If the player and dealer haven't hit black jack and hand isn't bust
+    if ((playerScore != BLACKJACK) && (dealerScore != BLACKJACK) && (!bust)) {
+
+        int action = strategyDecision(*g_strategy, playerHand, upCardValue(dealerHand),
+                                      canSplit, canDouble, canSurrender);
+
+        g_out << "\n\t" << STYLE_BOLD << "Advice:" << STYLE_NORMAL << " ";
+        if (action == HIT) {
+            g_out << STYLE_YELLOW << "You should " << STYLE_BOLD << "HIT" << STYLE_NORMAL << STYLE_YELLOW;
+        }
+        else {
+            g_out << STYLE_GREEN << "You should " << STYLE_BOLD << ACTION_NAMES[action] << STYLE_NORMAL << STYLE_GREEN;
+        }
+
+        // The Bicycle strategy also tells the player the target for this up card
+        if (g_strategy == &BICYCLE_STRATEGY) {
+            int upClass = cardEvlauator(dealerHand);
+            int target = (upClass == GOOD_CARD) ? GOOD_CARD_TARGET
+                       : (upClass == BAD_CARD) ? BAD_CARD_TARGET : FAIR_CARD_TARGET;
+            if (action == HIT) {
+                g_out << " until your score is at least " << target;
+            }
+            else if (action == STAND) {
+                g_out << " since your score is " << target << " or above";
+            }
+        }
+        g_out << STYLE_NORMAL;
+    // (Player score printed separately with soft/hard totals)
+
+    }
+}
+
+void initialAdvisor(CardArray& dealerHand, int playerScore, int dealerScore) {
+
+    PROFILE_SCOPE(PHASE_ADVISOR);
+    // Evaluates dealers up card
+    cardEvlauator(dealerHand);
+
+    // Conditions for calling advisor
+    if ((playerScore != BLACKJACK) && (dealerScore != BLACKJACK) && (playerScore < BLACKJACK)) {
+
+        // Statement for observation
+        g_out << "\n\n\tADVISOR observation: ";
+        // If up card is good
+        if (cardEvlauator(dealerHand) == GOOD_CARD) {
+            g_out << "The dealer upcard is good.";
+        }
+        // If up card is bad
+        if (cardEvlauator(dealerHand) == BAD_CARD) {
+            g_out << "The dealer upcard is bad.";
+        }
+        // If up card is fair
+        if (cardEvlauator(dealerHand) == FAIR_CARD) {
+            g_out << "The dealer upcard is fair.";
+        }
+    }
+}
+
+// Prints the exact EV of each action for the current hand, using every card the player
+// hasn't seen (the rest of the shoe plus the dealer's hole card). Only the actions the game
+// offers for this hand right now are shown, the same ones chooseAction accepts.
+void evAdvisor(const Shoe& shoe, const CardArray& playerHand, const CardArray& dealerHand,
+               bool canSplit, bool canDouble, bool canSurrender) {
+
+    PROFILE_SCOPE(PHASE_ADVISOR);
+    // One solver for the whole session, the caches carry over from hand to hand
+    static EvSolver solver;
+    solver.options.rules = g_rules;
+    solver.options.rules.numDecks = shoe.numDecks;
+    solver.dealer.hitSoft17 = g_rules.hitSoft17;
+
+    ShoeCounts unseen = remainingCounts(shoe);
+    for (int i = 1; i < dealerHand.usedCards; i++) {
+        unseen.count[HARD_VALUE[cardRank(dealerHand.cards[i])]]++;
+        unseen.total++;
+    }
+
+    ActionEV result = solveHand(solver, unseen, playerHand, upCardValue(dealerHand),
+                                canSplit, canDouble, canSurrender);
+
+    g_out << "\n\t" << STYLE_BOLD << "Exact EV:" << STYLE_NORMAL;
+    for (int a = 0; a < ACTION_COUNT; a++) {
+        if (result.allowed[a]) {
+            g_out << " ";
+            if (a == result.best) {
+                g_out << STYLE_BOLD;
+            }
+            g_out << ACTION_NAMES[a] << " " << fixedNumber(result.ev[a], 3, true) << STYLE_NORMAL;
+        }
+    }
+}
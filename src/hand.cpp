@@ -0,0 +1,171 @@
+// Hands: adding and drawing cards with running totals, splitting, and scoring a finished hand
+
+#include "blackjack.h"
+
+using namespace std;
+
+namespace blackjack {
+
+// Adds a card to the hand and updates its totals. Returns false, leaving the hand
+// as it was, if the hand is already full.
+bool addCard(CardArray& hand, Card card) {
+
+    if (hand.usedCards >= MAX_CARDS_IN_HAND) {
+        return false;
+    }
+    int rank = cardRank(card);
+    hand.cards[hand.usedCards++] = card;
+    // count ace as 1 for hard total, face cards as 10
+    hand.hardTotal += HARD_VALUE[rank];
+    hand.aceCount += (rank == 1);
+
+    // One Ace counts as 11 while that doesn't bust the hand, so no card is ever revalued
+    hand.soft = (hand.aceCount > 0 && hand.hardTotal + 10 <= BLACKJACK);
+    hand.score = hand.soft ? hand.hardTotal + 10 : hand.hardTotal;
+    hand.blackjack = (hand.usedCards == 2 && hand.score == BLACKJACK);
+    hand.bust = (hand.score > BLACKJACK);
+    return true;
+}
+
+// Empties the hand for the next round
+void clearHand(CardArray& hand) {
+
+    hand.usedCards = 0;
+    hand.hardTotal = 0;
+    hand.aceCount = 0;
+    hand.score = 0;
+    hand.soft = false;
+    hand.blackjack = false;
+    hand.bust = false;
+}
+
+// Moves the next card of the shoe into the hand without printing anything.
+// Returns true when the shoe ran out and had to be reshuffled.
+bool drawCard(Shoe& shoe, CardArray& hand, Rng& rng) {
+
+    PROFILE_SCOPE(PHASE_DEAL);
+    // A full hand takes no card, the shoe is left as it was
+    Card card = shoe.cards[shoe.nextCard];
+    if (!addCard(hand, card)) {
+        return false;
+    }
+    shoe.nextCard++;
+    shoe.runningCount += COUNT_TAGS[shoe.countSystem][cardRank(card)];
+
+    // Only happens when the cut card is at the very end of the shoe
+    if (shoe.nextCard == shoe.size) {
+        shuffleDeck(shoe, rng);
+        return true;
+    }
+    return false;
+}
+
+// Takes the next card of the shoe, for hands kept outside a CardArray (the batch evaluator).
+// Keeps the count and reshuffles when the shoe runs out, like drawCard.
+Card dealCard(Shoe& shoe, Rng& rng) {
+
+    PROFILE_SCOPE(PHASE_DEAL);
+    Card card = shoe.cards[shoe.nextCard];
+    shoe.nextCard++;
+    shoe.runningCount += COUNT_TAGS[shoe.countSystem][cardRank(card)];
+    if (shoe.nextCard == shoe.size) {
+        shuffleDeck(shoe, rng);
+    }
+    return card;
+}
+
+// Puts the player back to a single empty hand with a one unit bet
+void resetHands(PlayerHands& player) {
+
+    for (int h = 0; h < MAX_SPLIT_HANDS; h++) {
+        clearHand(player.hands[h]);
+        player.bets[h] = 1;
+        player.splitAces[h] = false;
+    }
+    player.count = 1;
+    player.surrendered = false;
+    player.insurance = 0;
+    player.actionCount = 0;
+}
+
+// Splits hand h in two. The second card moves to a new hand placed right after it, so
+// the hands are still played left to right. Both hands are left with one card.
+void splitHand(PlayerHands& player, int h) {
+
+    // Shift the hands after h along by one slot
+    for (int k = player.count; k > h + 1; k--) {
+        player.hands[k] = player.hands[k - 1];
+        player.bets[k] = player.bets[k - 1];
+        player.splitAces[k] = player.splitAces[k - 1];
+    }
+
+    CardArray& hand = player.hands[h];
+    CardArray& next = player.hands[h + 1];
+    Card first = hand.cards[0];
+    Card second = hand.cards[1];
+    bool aces = (cardRank(first) == 1);
+
+    clearHand(hand);
+    addCard(hand, first);
+    clearHand(next);
+    addCard(next, second);
+    player.bets[h + 1] = player.bets[h];
+    player.splitAces[h] = aces;
+    player.splitAces[h + 1] = aces;
+    player.count++;
+}
+
+// Evaluates whether the dealer up card is good, bad or fair
+int cardEvlauator(const CardArray& hand) {
+
+    return upCardClass(HARD_VALUE[cardRank(hand.cards[0])]);
+}
+
+// Compute soft (best <=21 considering one ace as 11 if possible) and hard totals.
+// The hand keeps its totals as cards are added, so nothing is rescanned.
+void computeTotals(const CardArray& hand, int &softTotal, int &hardTotal, int &aceCount) {
+    PROFILE_SCOPE(PHASE_TOTALS);
+    hardTotal = hand.hardTotal;
+    aceCount = hand.aceCount;
+    softTotal = hand.score;
+}
+
+
+// Returns the score used for a hand, soft total unless that would bust
+int scoreOf(const CardArray& hand) {
+
+    return hand.score;
+}
+
+// Decides WIN, LOSE or DRAW for a finished hand. Naturals are only possible on the
+// original two cards, the caller says whether each side has one.
+int evaluateHand(int playerScore, bool playerBlackjack, int dealerScore, bool dealerBlackjack) {
+
+    PROFILE_SCOPE(PHASE_EVALUATE);
+    // Dealer blackjack beats everything but another blackjack
+    if (dealerBlackjack) {
+        return playerBlackjack ? DRAW : LOSE;
+    }
+    // Player bust loses
+    if (playerScore > BLACKJACK) {
+        return LOSE;
+    }
+    // Player blackjack wins
+    if (playerBlackjack) {
+        return WIN;
+    }
+    // Dealer bust wins
+    if (dealerScore > BLACKJACK) {
+        return WIN;
+    }
+    // Otherwise the higher score wins
+    if (playerScore > dealerScore) {
+        return WIN;
+    }
+    else if (playerScore < dealerScore) {
+        return LOSE;
+    }
+    return DRAW;
+}
+
+} // namespace blackjack
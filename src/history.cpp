@@ -0,0 +1,483 @@
+// Hand history: recording a simulation run to a binary log and replaying it bit for bit
+
+#include "blackjack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+namespace blackjack {
+
+// Largest hand record: tag, shoe, cards, decision count, the decisions, result and bet
+const size_t HISTORY_HAND_BYTES = 6 + MAX_ROUND_ACTIONS + 16;
+
+// Results are nearly always whole or half units and fit one signed byte as half units,
+// any other result is this marker followed by the double
+const int HISTORY_RESULT_DOUBLE = 127;
+
+// Little endian writers, the log reads the same on every machine
+static void putByte(vector<unsigned char>& out, size_t& used, unsigned value) {
+    out[used++] = (unsigned char)value;
+}
+
+static void putWord(vector<unsigned char>& out, size_t& used, uint64_t value, int bytes) {
+    for (int b = 0; b < bytes; b++) {
+        out[used++] = (unsigned char)(value >> (8 * b));
+    }
+}
+
+static void putDouble(vector<unsigned char>& out, size_t& used, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    putWord(out, used, bits, 8);
+}
+
+// Writes a round result, one byte of half units when that is exact
+static void putResult(vector<unsigned char>& out, size_t& used, double result) {
+    double halves = result * 2;
+    if (halves >= -HISTORY_RESULT_DOUBLE && halves < HISTORY_RESULT_DOUBLE && halves == (int)halves) {
+        putByte(out, used, (unsigned char)(signed char)(int)halves);
+    }
+    else {
+        putByte(out, used, HISTORY_RESULT_DOUBLE);
+        putDouble(out, used, result);
+    }
+}
+
+// Structure for reading a log back, fails once it runs past the end
+struct HistoryReader {
+
+    const unsigned char* data;  // bytes being read
+    size_t size;                // bytes available
+    size_t pos;                 // next byte to read
+    bool failed;                // a read went past the end
+
+    // Constructor for HistoryReader
+    HistoryReader(const unsigned char* bytes, size_t count) {
+        data = bytes;
+        size = count;
+        pos = 0;
+        failed = false;
+    }
+};
+
+static uint64_t getWord(HistoryReader& in, int bytes) {
+    if (in.pos + bytes > in.size) {
+        in.failed = true;
+        in.pos = in.size;
+        return 0;
+    }
+    uint64_t value = 0;
+    for (int b = 0; b < bytes; b++) {
+        value |= (uint64_t)in.data[in.pos++] << (8 * b);
+    }
+    return value;
+}
+
+static double getDouble(HistoryReader& in) {
+    uint64_t bits = getWord(in, 8);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static double getResult(HistoryReader& in) {
+    int halves = (signed char)getWord(in, 1);
+    return halves == HISTORY_RESULT_DOUBLE ? getDouble(in) : halves / 2.0;
+}
+
+// Creates the log and writes its header: the seed, the worker count and every setting
+// the simulation depends on, so a replay needs nothing but the file
+bool openHistory(HistoryFile& file, const string& path, const SimConfig& config, long long hands,
+                 int threads, uint64_t seed, string& error) {
+
+    file.out.open(path, ios::binary | ios::trunc);
+    if (!file.out) {
+        error = "cannot create hand history file";
+        return false;
+    }
+    file.failed = false;
+
+    vector<unsigned char> header(128 + 8 * config.spread.size() + sizeof(StrategyTable));
+    size_t used = 0;
+    for (int i = 0; i < 4; i++) {
+        putByte(header, used, HISTORY_MAGIC[i]);
+    }
+    putWord(header, used, seed, 8);
+    putWord(header, used, (uint64_t)hands, 8);
+    putWord(header, used, (uint64_t)threads, 4);
+    putByte(header, used, config.rngKind);
+    putWord(header, used, (uint64_t)config.shuffleBatch, 4);
+    putDouble(header, used, config.penetration);
+    putByte(header, used, config.takeInsurance);
+    putByte(header, used, config.countSystem);
+    putByte(header, used, config.dealerMode);
+    putDouble(header, used, config.bankroll);
+    putByte(header, used, config.rules.numDecks);
+    putByte(header, used, config.rules.hitSoft17);
+    putDouble(header, used, config.rules.blackjackPays);
+    putByte(header, used, config.rules.doubleAfterSplit);
+    putByte(header, used, config.rules.maxHands);
+    putByte(header, used, config.rules.surrender);
+    putWord(header, used, config.spread.size(), 4);
+    for (size_t k = 0; k < config.spread.size(); k++) {
+        putDouble(header, used, config.spread[k]);
+    }
+    for (int row = 0; row < STRATEGY_ROWS; row++) {
+        for (int column = 0; column < STRATEGY_COLUMNS; column++) {
+            putByte(header, used, config.strategy->action[row][column]);
+        }
+    }
+    file.out.write((const char*)&header[0], used);
+    if (!file.out) {
+        error = "cannot write hand history file";
+        return false;
+    }
+    return true;
+}
+
+// Closes the log once every worker has finished, reports whether all of it was written
+bool closeHistory(HistoryFile& file, string& error) {
+
+    file.out.close();
+    if (file.failed || !file.out) {
+        error = "hand history file is incomplete, a write failed";
+        return false;
+    }
+    return true;
+}
+
+// Sets up a worker's writer for the run the config describes
+void startHistory(HistoryWriter& writer, const SimConfig& config, int worker) {
+
+    writer.file = config.history;
+    writer.log = config.replay;
+    writer.worker = worker;
+    writer.withBets = !config.spread.empty();
+    writer.buffer.assign(HISTORY_BUFFER, 0);
+    writer.used = 0;
+    writer.offset = 0;
+    writer.handsRecorded = 0;
+    writer.mismatch = -1;
+}
+
+// Appends the buffered records to the log as one chunk: worker, length, records
+static void writeChunk(HistoryWriter& writer) {
+
+    if (writer.used == 0) {
+        return;
+    }
+    unsigned char chunk[8];
+    for (int b = 0; b < 4; b++) {
+        chunk[b] = (unsigned char)(writer.worker >> (8 * b));
+        chunk[4 + b] = (unsigned char)(writer.used >> (8 * b));
+    }
+    HistoryFile& file = *writer.file;
+    {
+        lock_guard<mutex> guard(file.lock);
+        file.out.write((const char*)chunk, sizeof(chunk));
+        file.out.write((const char*)&writer.buffer[0], writer.used);
+        if (!file.out) {
+            file.failed = true;
+        }
+    }
+    writer.used = 0;
+}
+
+// Makes room for a record of up to bytes bytes
+static void reserveRecord(HistoryWriter& writer, size_t bytes) {
+
+    if (writer.used + bytes > writer.buffer.size()) {
+        writeChunk(writer);
+        if (bytes > writer.buffer.size()) {
+            writer.buffer.resize(bytes);
+        }
+    }
+}
+
+// A record is complete. Recording keeps it buffered, replaying compares it with the same
+// bytes of the recorded stream and notes the first hand where they differ.
+static void endRecord(HistoryWriter& writer) {
+
+    if (writer.log == nullptr) {
+        return;
+    }
+    const vector<unsigned char>& stream = writer.log->streams[writer.worker];
+    if (writer.mismatch < 0 && (writer.offset + writer.used > stream.size() ||
+                                memcmp(&writer.buffer[0], &stream[writer.offset], writer.used) != 0)) {
+        writer.mismatch = writer.handsRecorded;
+    }
+    writer.offset += writer.used;
+    writer.used = 0;
+}
+
+// Writes out what is left in the buffer. A replay also checks the log has no more records.
+void finishHistory(HistoryWriter& writer) {
+
+    if (writer.log == nullptr) {
+        writeChunk(writer);
+        return;
+    }
+    if (writer.mismatch < 0 && writer.offset != writer.log->streams[writer.worker].size()) {
+        writer.mismatch = writer.handsRecorded;
+    }
+    writer.log->mismatch[writer.worker] = writer.mismatch;
+}
+
+// Logs the order of every shoe in the batch right after they were shuffled
+void recordShuffle(HistoryWriter& writer, const Shoe* shoes, int count) {
+
+    size_t bytes = 1;
+    for (int k = 0; k < count; k++) {
+        bytes += shoes[k].size;
+    }
+    reserveRecord(writer, bytes);
+    putByte(writer.buffer, writer.used, HISTORY_SHUFFLE);
+    for (int k = 0; k < count; k++) {
+        memcpy(&writer.buffer[writer.used], shoes[k].cards, shoes[k].size);
+        writer.used += shoes[k].size;
+    }
+    endRecord(writer);
+}
+
+// Logs the new order of a shoe that ran out and was reshuffled in the middle of a round,
+// ahead of that round's record
+void recordReshuffle(HistoryWriter& writer, int shoe, const Shoe& shuffled) {
+
+    reserveRecord(writer, 3 + shuffled.size);
+    putByte(writer.buffer, writer.used, HISTORY_RESHUFFLE);
+    putWord(writer.buffer, writer.used, (uint64_t)shoe, 2);
+    memcpy(&writer.buffer[writer.used], shuffled.cards, shuffled.size);
+    writer.used += shuffled.size;
+    endRecord(writer);
+}
+
+// Logs a finished round: the shoe it was dealt from, how many cards it took, the player's
+// decisions and the result per unit bet (and the bet itself when betting a spread).
+// A count that doesn't fit the record marks the log as failed rather than wrapping.
+void recordHand(HistoryWriter& writer, int shoe, int cardsDealt, const PlayerHands& player,
+                double bet, double result) {
+
+    if (cardsDealt < 0 || cardsDealt > HISTORY_MAX_CARDS) {
+        if (writer.file != nullptr) {
+            lock_guard<mutex> guard(writer.file->lock);
+            writer.file->failed = true;
+        }
+        else if (writer.mismatch < 0) {
+            writer.mismatch = writer.handsRecorded;
+        }
+        return;
+    }
+    reserveRecord(writer, HISTORY_HAND_BYTES);
+    vector<unsigned char>& out = writer.buffer;
+    size_t& used = writer.used;
+    putByte(out, used, HISTORY_HAND);
+    putWord(out, used, (uint64_t)shoe, 2);
+    putByte(out, used, cardsDealt);
+    putByte(out, used, player.actionCount);
+    memcpy(&out[used], player.actions, player.actionCount);
+    used += player.actionCount;
+    putResult(out, used, result);
+    if (writer.withBets) {
+        putDouble(out, used, bet);
+    }
+    endRecord(writer);
+    writer.handsRecorded++;
+}
+
+// Reads a log: the header back into a simulation config, and the chunks joined into
+// one record stream per worker
+bool readHistory(const string& path, HistoryLog& log, string& error) {
+
+    ifstream file(path, ios::binary);
+    if (!file) {
+        error = "cannot open hand history file";
+        return false;
+    }
+    vector<unsigned char> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    if (data.size() < 4 || memcmp(&data[0], HISTORY_MAGIC, 4) != 0) {
+        error = "not a hand history file";
+        return false;
+    }
+
+    HistoryReader in(&data[0], data.size());
+    in.pos = 4;
+    SimConfig& config = log.config;
+    log.seed = getWord(in, 8);
+    log.hands = (long long)getWord(in, 8);
+    log.threads = (int)getWord(in, 4);
+    config.rngKind = (int)getWord(in, 1);
+    config.shuffleBatch = (int)getWord(in, 4);
+    config.penetration = getDouble(in);
+    config.takeInsurance = getWord(in, 1) != 0;
+    config.countSystem = (int)getWord(in, 1);
+    config.dealerMode = (int)getWord(in, 1);
+    config.bankroll = getDouble(in);
+    config.rules.numDecks = (int)getWord(in, 1);
+    config.rules.hitSoft17 = getWord(in, 1) != 0;
+    config.rules.blackjackPays = getDouble(in);
+    config.rules.doubleAfterSplit = getWord(in, 1) != 0;
+    config.rules.maxHands = (int)getWord(in, 1);
+    config.rules.surrender = getWord(in, 1) != 0;
+    size_t spreadSize = (size_t)getWord(in, 4);
+    if (spreadSize > data.size()) {
+        error = "hand history header is damaged";
+        return false;
+    }
+    config.spread.resize(spreadSize);
+    for (size_t k = 0; k < spreadSize; k++) {
+        config.spread[k] = getDouble(in);
+    }
+    for (int row = 0; row < STRATEGY_ROWS; row++) {
+        for (int column = 0; column < STRATEGY_COLUMNS; column++) {
+            log.strategy.action[row][column] = (unsigned char)getWord(in, 1);
+        }
+    }
+    config.strategy = &log.strategy;
+    string rulesError;
+    if (in.failed || log.threads < 1 || config.rngKind >= RNG_KINDS || config.shuffleBatch < 1 ||
+        config.countSystem >= COUNT_SYSTEMS || config.dealerMode > DEALER_INFINITE ||
+        !checkRules(config.rules, rulesError)) {
+        error = "hand history header is damaged";
+        return false;
+    }
+
+    log.streams.assign(log.threads, vector<unsigned char>());
+    log.mismatch.assign(log.threads, -1);
+    while (in.pos < in.size) {
+        int worker = (int)getWord(in, 4);
+        size_t length = (size_t)getWord(in, 4);
+        if (in.failed || worker >= log.threads || length > in.size - in.pos) {
+            error = "hand history file is truncated or damaged";
+            return false;
+        }
+        log.streams[worker].insert(log.streams[worker].end(), in.data + in.pos, in.data + in.pos + length);
+        in.pos += length;
+    }
+    return true;
+}
+
+// Prints every record of the log, one line per shuffle and per round: the cards the round
+// took from the shoe in the order they were dealt, the decisions and the result
+void dumpHistory(const HistoryLog& log) {
+
+    int shoeSize = log.config.rules.numDecks * MAX_DECK_SIZE;
+    bool withBets = !log.config.spread.empty();
+    cout << fixed << setprecision(4);
+    for (int w = 0; w < log.threads; w++) {
+        const vector<unsigned char>& stream = log.streams[w];
+        HistoryReader in(stream.empty() ? nullptr : &stream[0], stream.size());
+        vector<unsigned char> order;
+        vector<int> position;
+        vector<vector<unsigned char> > reshuffled;     // new order of a shoe that ran out, by shoe
+        long long hand = 0;
+        while (in.pos < in.size && !in.failed) {
+            int tag = (int)getWord(in, 1);
+            if (tag == HISTORY_SHUFFLE) {
+                size_t bytes = (size_t)shoeSize * log.config.shuffleBatch;
+                if (bytes > in.size - in.pos) {
+                    break;
+                }
+                order.assign(in.data + in.pos, in.data + in.pos + bytes);
+                position.assign(log.config.shuffleBatch, 0);
+                reshuffled.assign(log.config.shuffleBatch, vector<unsigned char>());
+                in.pos += bytes;
+                cout << "worker " << w << " shuffle before hand " << hand << "\n";
+                continue;
+            }
+            if (tag == HISTORY_RESHUFFLE) {
+                int shoe = (int)getWord(in, 2);
+                if (in.failed || shoe >= (int)position.size() || (size_t)shoeSize > in.size - in.pos) {
+                    break;
+                }
+                reshuffled[shoe].assign(in.data + in.pos, in.data + in.pos + shoeSize);
+                in.pos += shoeSize;
+                cout << "worker " << w << " shoe " << shoe << " reshuffled during hand " << hand << "\n";
+                continue;
+            }
+            if (tag != HISTORY_HAND) {
+                break;
+            }
+            int shoe = (int)getWord(in, 2);
+            int cards = (int)getWord(in, 1);
+            int actions = (int)getWord(in, 1);
+            if (in.failed || shoe >= (int)position.size() || in.pos + actions > in.size) {
+                break;
+            }
+            // A reshuffle during the round deals the rest of the old order, then the new one
+            int left = shoeSize - position[shoe];
+            bool ranOut = !reshuffled[shoe].empty();
+            if (ranOut ? (cards < left || cards - left > shoeSize) : (cards > left)) {
+                break;
+            }
+            cout << "worker " << w << " hand " << hand << " shoe " << shoe << ":";
+            for (int c = 0; c < cards; c++) {
+                if (ranOut && c == left) {
+                    copy(reshuffled[shoe].begin(), reshuffled[shoe].end(), order.begin() + (size_t)shoe * shoeSize);
+                    position[shoe] = -left;
+                }
+                Card card;
+                card.code = order[(size_t)shoe * shoeSize + position[shoe] + c];
+                cout << " " << cardName(card);
+            }
+            if (ranOut && cards == left) {
+                copy(reshuffled[shoe].begin(), reshuffled[shoe].end(), order.begin() + (size_t)shoe * shoeSize);
+                position[shoe] = -left;
+            }
+            reshuffled[shoe].clear();
+            position[shoe] += cards;
+            cout << " |";
+            for (int a = 0; a < actions; a++) {
+                int action = in.data[in.pos++];
+                cout << " " << (action < ACTION_COUNT ? ACTION_CODES[action] : "?");
+            }
+            double result = getResult(in);
+            cout << " | " << showpos << result << noshowpos;
+            if (withBets) {
+                cout << " x " << getDouble(in);
+            }
+            cout << "\n";
+            hand++;
+        }
+        if (in.pos < in.size || in.failed) {
+            cout << "worker " << w << " records are damaged after hand " << hand << "\n";
+        }
+    }
+    cout.flush();
+}
+
+// Entry point for --replay: reruns a recorded simulation from its header and checks every
+// shuffle and every round comes out exactly as logged
+int runReplay(const string& path, bool dump) {
+
+    HistoryLog log;
+    string error;
+    if (!readHistory(path, log, error)) {
+        cerr << path << ": " << error << endl;
+        return 1;
+    }
+    if (dump) {
+        dumpHistory(log);
+    }
+
+    SimConfig config = log.config;
+    config.replay = &log;
+    runSimulation(log.hands, "replay of " + path, config, log.threads, log.seed);
+
+    bool matches = true;
+    for (int w = 0; w < log.threads; w++) {
+        if (log.mismatch[w] >= 0) {
+            cout << "replay:  worker " << w << " differs from the log at hand " << log.mismatch[w] << "\n";
+            matches = false;
+        }
+    }
+    if (matches) {
+        cout << "replay:  all " << log.hands << " hands match the log" << endl;
+    }
+    return matches ? 0 : 1;
+}
+
+} // namespace blackjack
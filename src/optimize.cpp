@@ -0,0 +1,422 @@
+// Threshold optimizer: a grid of advisor parameters races on common random numbers, the
+// candidates that are clearly behind drop out after each stage and the neighbours of the best
+// ones are tried until none is left to try
+
+#include "blackjack.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <unordered_set>
+
+using namespace std;
+
+namespace blackjack {
+
+// Builds the strategy table of a set of advisor parameters
+StrategyTable makeAdvisorStrategy(const AdvisorParams& params) {
+
+    return makeTargetStrategy(params.goodTarget, params.badTarget, params.fairTarget,
+                              params.badValue, params.goodValue);
+}
+
+// Up card values from first to last, like "4-6", "7-A" or "none"
+static string upCardRange(int first, int last) {
+
+    if (first > last) {
+        return "none";
+    }
+    string from = (first == 11) ? "A" : to_string(first);
+    string to = (last == 11) ? "A" : to_string(last);
+    return (first == last) ? from : from + "-" + to;
+}
+
+// Name of a parameter set, the targets for good, bad and fair up cards, then which cards are
+// which, like "17/12/13 fair 2-3 bad 4-6 good 7-A"
+string advisorParamsName(const AdvisorParams& params) {
+
+    return to_string(params.goodTarget) + "/" + to_string(params.badTarget) + "/" + to_string(params.fairTarget)
+         + " fair " + upCardRange(OPTIMIZE_VALUE_MIN, params.badValue - 1)
+         + " bad " + upCardRange(params.badValue, params.goodValue - 1)
+         + " good " + upCardRange(params.goodValue, OPTIMIZE_VALUE_MAX);
+}
+
+// Whether a parameter set lies inside the searched space
+static bool validParams(const AdvisorParams& params) {
+
+    int targets[3] = { params.goodTarget, params.badTarget, params.fairTarget };
+    for (int k = 0; k < 3; k++) {
+        if (targets[k] < OPTIMIZE_TARGET_MIN || targets[k] > OPTIMIZE_TARGET_MAX) {
+            return false;
+        }
+    }
+    return OPTIMIZE_VALUE_MIN <= params.badValue && params.badValue <= params.goodValue
+        && params.goodValue <= OPTIMIZE_VALUE_MAX;
+}
+
+// Adds a candidate unless it's outside the space or plays exactly like one already tried.
+// An empty class of up cards makes its target meaningless, those sets all build one table.
+static bool addCandidate(vector<OptimizeCandidate>& candidates, unordered_set<string>& tried,
+                         const AdvisorParams& params) {
+
+    if (!validParams(params)) {
+        return false;
+    }
+    OptimizeCandidate candidate;
+    candidate.params = params;
+    candidate.table = makeAdvisorStrategy(params);
+    string key((const char*)&candidate.table, sizeof(candidate.table));
+    if (!tried.insert(key).second) {
+        return false;
+    }
+    candidates.push_back(candidate);
+    return true;
+}
+
+// Plays every round once per strategy with playRoundEach. The first strategy is the stage's
+// leader, it plays last and moves the shoe on. Each candidate's result is also tallied minus
+// the leader's and minus the reference's (Bicycle) on the same round. Bets come from the count
+// before the round and are the same for all.
+template <typename R>
+static void raceRoundsWith(Shoe& shoe, Rng& rng, long long rounds, const SimConfig& config,
+                           const vector<const StrategyTable*>& strategies, int reference, RaceTally* out,
+                           const R& rules) {
+
+    int count = (int)strategies.size();
+    bool spreadBets = !config.spread.empty();
+    vector<double> outcomes(count);
+
+    // Hands live on the stack for the whole run, no allocation per round or per split
+    PlayerHands player;
+    CardArray dealerHand;
+
+    // Order of the cards since the last shuffle, for a round that runs the shoe out
+    vector<Card> saved(shoe.cards, shoe.cards + shoe.size);
+
+    for (long long i = 0; i < rounds; i++) {
+        if (shoe.nextCard >= shoe.cutCard) {
+            shuffleBatch(&shoe, &rng, 1);
+            copy(shoe.cards, shoe.cards + shoe.size, saved.begin());
+        }
+        double bet = spreadBets ? betForCount(config.spread, trueCount(shoe)) : 1;
+        playRoundEach(shoe, rng, &strategies[0], count, player, dealerHand, rules,
+                      config.takeInsurance, config.dealerTable, saved, &outcomes[0]);
+
+        for (int c = 0; c < count; c++) {
+            addSample(out[c].returns, bet * outcomes[c]);
+            addSample(out[c].difference, bet * (outcomes[c] - outcomes[0]));
+            addSample(out[c].improvement, bet * (outcomes[c] - outcomes[reference]));
+        }
+    }
+}
+
+// Plays the rounds under the configured rules, the common rule sets run a copy compiled for them
+void raceRounds(Shoe& shoe, Rng& rng, long long rounds, const SimConfig& config,
+                const vector<const StrategyTable*>& strategies, int reference, RaceTally* out) {
+
+    if (matchesRules(config.rules, FixedRules<false>())) {
+        raceRoundsWith(shoe, rng, rounds, config, strategies, reference, out, FixedRules<false>());
+    }
+    else if (matchesRules(config.rules, FixedRules<true>())) {
+        raceRoundsWith(shoe, rng, rounds, config, strategies, reference, out, FixedRules<true>());
+    }
+    else {
+        raceRoundsWith(shoe, rng, rounds, config, strategies, reference, out, config.rules);
+    }
+}
+
+// Plays one worker's share of a stage into its own slot
+void raceWorker(SimWorker& worker, long long rounds, const SimConfig& config,
+                const vector<const StrategyTable*>& strategies, int reference, RaceWorkerResult* out) {
+
+    out->tallies.assign(strategies.size(), RaceTally());
+    raceRounds(worker.shoes[0], worker.rngs[0], rounds, config, strategies, reference, &out->tallies[0]);
+}
+
+// Structure for the state of a whole optimizer run
+struct OptimizeRun {
+
+    SimConfig sim;
+    long long maxRounds;    // most rounds a candidate plays in one stage
+    int threads;
+    uint64_t seed;
+    int stages;             // stages played so far, each deals from fresh random streams
+    long long played;       // rounds played by all candidates together
+    int leader;             // candidate ahead after the last stage
+    int pacer;              // leader going into the last stage, the one its differences are to
+    int reference;          // the Bicycle strategy, never dropped so everything is measured against it
+    vector<OptimizeCandidate> candidates;
+
+    // Constructor for OptimizeRun
+    OptimizeRun() {
+        maxRounds = 0;
+        threads = 1;
+        seed = 0;
+        stages = 0;
+        played = 0;
+        leader = 0;
+        pacer = 0;
+        reference = 0;
+    }
+};
+
+// Plays one stage: every live candidate plays the same rounds, split across the threads. The
+// leader goes first in the list so the others are measured against it round by round.
+static void playStage(OptimizeRun& run, long long rounds) {
+
+    run.pacer = run.leader;
+    vector<int> order(1, run.leader);
+    for (int c = 0; c < (int)run.candidates.size(); c++) {
+        if (run.candidates[c].alive && c != run.leader) {
+            order.push_back(c);
+        }
+    }
+    vector<const StrategyTable*> strategies(order.size());
+    int reference = 0;
+    for (size_t k = 0; k < order.size(); k++) {
+        strategies[k] = &run.candidates[order[k]].table;
+        if (order[k] == run.reference) {
+            reference = (int)k;
+        }
+    }
+
+    // Fresh streams every stage, so a candidate that got lucky once doesn't stay lucky
+    vector<RaceWorkerResult> slots(run.threads);
+    vector<SimWorker> states(run.threads);
+    vector<thread> workers;
+    long long share = rounds / run.threads;
+    long long extra = rounds % run.threads;
+    for (int t = 0; t < run.threads; t++) {
+        startWorker(states[t], run.sim, run.seed, run.stages * run.threads + t);
+    }
+    for (int t = 0; t < run.threads; t++) {
+        long long part = share + (t < extra ? 1 : 0);
+        if (t == run.threads - 1) {
+            raceWorker(states[t], part, run.sim, strategies, reference, &slots[t]);
+        }
+        else {
+            workers.push_back(thread(raceWorker, ref(states[t]), part, cref(run.sim), cref(strategies),
+                                     reference, &slots[t]));
+        }
+    }
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+    for (int t = 0; t < run.threads; t++) {
+        finishWorker(states[t]);
+    }
+
+    for (size_t k = 0; k < order.size(); k++) {
+        RaceTally& tally = run.candidates[order[k]].tally;
+        tally = RaceTally();
+        for (int t = 0; t < run.threads; t++) {
+            mergeStats(tally.returns, slots[t].tallies[k].returns);
+            mergeStats(tally.difference, slots[t].tallies[k].difference);
+            mergeStats(tally.improvement, slots[t].tallies[k].improvement);
+        }
+    }
+    run.stages++;
+    run.played += rounds * (long long)order.size();
+}
+
+// Races the live candidates in stages of growing length. After each stage the candidates
+// clearly behind the leader drop out, and so do those that played every round exactly like it.
+// Stops when one is left, the stage reached the most rounds, or with a target precision when
+// every live candidate's difference to the leader is known that well.
+static void race(OptimizeRun& run) {
+
+    double prune = normalQuantile(0.5 + OPTIMIZE_PRUNE_CONFIDENCE / 2);
+    long long rounds = min(OPTIMIZE_FIRST_ROUNDS, run.maxRounds);
+    for (;;) {
+        playStage(run, rounds);
+
+        int alive = 0;
+        int dropped = 0;
+        bool reached = (run.sim.precision > 0);
+        int best = run.leader;
+        for (int c = 0; c < (int)run.candidates.size(); c++) {
+            OptimizeCandidate& candidate = run.candidates[c];
+            if (!candidate.alive || c == run.leader) {
+                continue;
+            }
+            const RunningStats& diff = candidate.tally.difference;
+            bool behind = diff.mean + prune * standardError(diff) < 0;
+            bool same = (diff.mean == 0 && diff.m2 == 0);
+            if ((behind || same) && c != run.reference) {
+                candidate.alive = false;
+                dropped++;
+                continue;
+            }
+            alive++;
+            reached = reached && confidenceHalfWidth(diff, run.sim.confidence) <= run.sim.precision;
+            if (diff.mean > run.candidates[best].tally.difference.mean) {
+                best = c;
+            }
+        }
+        const RaceTally& lead = run.candidates[best].tally;
+        cout << "stage " << setw(2) << run.stages << ": " << setw(6) << alive + dropped + 1 << " candidates x "
+             << setw(9) << rounds << " rounds, " << setw(6) << dropped << " dropped, leader "
+             << advisorParamsName(run.candidates[best].params) << setprecision(4) << showpos
+             << " " << lead.returns.mean << noshowpos << endl;
+        run.leader = best;
+
+        // Only the reference left beside the leader counts as one left
+        bool referenceOnly = (alive == 1 && run.candidates[run.reference].alive && run.leader != run.reference);
+        if (alive == 0 || referenceOnly || rounds >= run.maxRounds || reached) {
+            return;
+        }
+        rounds = min(rounds * OPTIMIZE_GROWTH, run.maxRounds);
+    }
+}
+
+// Live candidates, best first by their last stage's result against the leader
+static vector<int> ranking(const OptimizeRun& run) {
+
+    vector<int> order;
+    for (int c = 0; c < (int)run.candidates.size(); c++) {
+        if (run.candidates[c].alive) {
+            order.push_back(c);
+        }
+    }
+    sort(order.begin(), order.end(), [&run](int a, int b) {
+        return run.candidates[a].tally.difference.mean > run.candidates[b].tally.difference.mean;
+    });
+    return order;
+}
+
+// Adds the untried neighbours of the best live candidates, every set within one step of each
+// parameter. Returns how many were added.
+static int refine(OptimizeRun& run, unordered_set<string>& tried) {
+
+    vector<int> order = ranking(run);
+    int added = 0;
+    for (size_t k = 0; k < order.size() && k < (size_t)OPTIMIZE_REFINE_TOP; k++) {
+        AdvisorParams center = run.candidates[order[k]].params;
+        for (int step = 0; step < 243; step++) {
+            // Each of the five parameters moves by -1, 0 or +1
+            int digits = step;
+            int move[5];
+            for (int d = 0; d < 5; d++) {
+                move[d] = digits % 3 - 1;
+                digits /= 3;
+            }
+            AdvisorParams params = center;
+            params.goodTarget += move[0];
+            params.badTarget += move[1];
+            params.fairTarget += move[2];
+            params.badValue += move[3];
+            params.goodValue += move[4];
+            if (addCandidate(run.candidates, tried, params)) {
+                added++;
+            }
+        }
+    }
+    return added;
+}
+
+// Entry point for --optimize. Races a coarse grid of advisor parameters, then the neighbours
+// of the best ones until no new neighbour is left, and prints the best set with its EV and how
+// far it's ahead of the Bicycle strategy, both with confidence intervals from the last stage.
+// Rounds is the most any candidate plays in one stage.
+int runOptimizer(long long rounds, const SimConfig& config, int threads, uint64_t seed) {
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    OptimizeRun run;
+    run.sim = config;
+    run.sim.shuffleBatch = 1;
+    run.maxRounds = rounds;
+    run.threads = threads;
+    run.seed = seed;
+    DealerTable dealerTable;
+    if (run.sim.dealerMode == DEALER_SHOE || run.sim.dealerMode == DEALER_INFINITE) {
+        buildDealerTable(dealerTable, run.sim.rules, run.sim.dealerMode);
+        run.sim.dealerTable = &dealerTable;
+    }
+    const SimConfig& sim = run.sim;
+
+    cout << fixed << setprecision(4);
+    cout << "optimize: targets " << OPTIMIZE_TARGET_MIN << "-" << OPTIMIZE_TARGET_MAX << ", boundaries "
+         << upCardRange(OPTIMIZE_VALUE_MIN, OPTIMIZE_VALUE_MAX) << "\n";
+    cout << "seed:    " << seed << "\n";
+    cout << "rng:     " << RNG_NAMES[sim.rngKind] << "\n";
+    cout << "decks:   " << sim.rules.numDecks << " (cut at " << setprecision(0) << sim.penetration * 100 << "%)\n";
+    cout << "rules:   " << rulesName(sim.rules) << "\n";
+    cout << "dealer:  " << DEALER_MODE_NAMES[sim.dealerMode] << "\n";
+    cout << "threads: " << threads << endl;
+
+    // The Bicycle strategy first, then the grid: every boundary, the targets in coarse steps
+    unordered_set<string> tried;
+    addCandidate(run.candidates, tried, AdvisorParams());
+    for (int badValue = OPTIMIZE_VALUE_MIN; badValue <= OPTIMIZE_VALUE_MAX; badValue++) {
+        for (int goodValue = badValue; goodValue <= OPTIMIZE_VALUE_MAX; goodValue++) {
+            for (int good = OPTIMIZE_TARGET_MIN; good <= OPTIMIZE_TARGET_MAX; good += OPTIMIZE_GRID_STEP) {
+                for (int bad = OPTIMIZE_TARGET_MIN; bad <= OPTIMIZE_TARGET_MAX; bad += OPTIMIZE_GRID_STEP) {
+                    for (int fair = OPTIMIZE_TARGET_MIN; fair <= OPTIMIZE_TARGET_MAX; fair += OPTIMIZE_GRID_STEP) {
+                        AdvisorParams params;
+                        params.goodTarget = good;
+                        params.badTarget = bad;
+                        params.fairTarget = fair;
+                        params.badValue = badValue;
+                        params.goodValue = goodValue;
+                        addCandidate(run.candidates, tried, params);
+                    }
+                }
+            }
+        }
+    }
+    cout << "grid:    " << run.candidates.size() << " distinct candidates" << endl;
+    run.reference = 0;
+    run.leader = 0;
+    race(run);
+
+    for (;;) {
+        int added = refine(run, tried);
+        if (added == 0) {
+            break;
+        }
+        cout << "refine:  " << added << " neighbours of the best" << endl;
+        race(run);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Every candidate played the same rounds in the last stage, measured against its pacer
+    vector<int> order = ranking(run);
+    const OptimizeCandidate& best = run.candidates[order[0]];
+    const RaceTally& tally = best.tally;
+    string interval = "+/-" + to_string((int)lround(sim.confidence * 100)) + "%";
+    cout << "tried:   " << run.candidates.size() << " candidates in " << run.stages << " stages\n";
+    cout << "best:    " << advisorParamsName(best.params) << "\n";
+    cout << "rounds:  " << tally.returns.count << " in the last stage\n";
+    cout << setprecision(4) << showpos;
+    cout << "EV/hand: " << tally.returns.mean << noshowpos << " " << interval << " "
+         << confidenceHalfWidth(tally.returns, sim.confidence) << "\n";
+    cout << "vs bicycle: " << showpos << tally.improvement.mean << noshowpos << " " << interval << " "
+         << confidenceHalfWidth(tally.improvement, sim.confidence) << "\n";
+
+    // Differences are to the pacer, which sits at +0 with no error and need not be the best
+    cout << "pacer:   " << advisorParamsName(run.candidates[run.pacer].params)
+         << ", the leader going into the last stage\n";
+    cout << left << setw(40) << "candidate" << right << setw(10) << "EV/hand" << setw(10) << "vs pacer"
+         << setw(9) << "SE" << setw(11) << "vs bicycle" << setw(9) << "SE" << "\n";
+    for (size_t k = 0; k < order.size() && k < (size_t)OPTIMIZE_SHOW; k++) {
+        const OptimizeCandidate& candidate = run.candidates[order[k]];
+        const RaceTally& row = candidate.tally;
+        cout << left << setw(40) << advisorParamsName(candidate.params) << right << showpos << setprecision(4)
+             << setw(10) << row.returns.mean << setw(10) << row.difference.mean << noshowpos << setprecision(5) << setw(9)
+             << standardError(row.difference) << showpos << setprecision(4) << setw(11) << row.improvement.mean
+             << noshowpos << setprecision(5) << setw(9) << standardError(row.improvement) << "\n";
+    }
+
+    cout << "strategy:\n";
+    printStrategy(best.table);
+    cout << fixed << setprecision(2);
+    cout << "seconds: " << seconds << "\n";
+    cout << "rounds/s: " << (seconds > 0 ? run.played / seconds : 0.0) << endl;
+    return 0;
+}
+
+} // namespace blackjack
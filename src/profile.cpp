@@ -0,0 +1,137 @@
+// Instrumentation: per thread phase counters, added up when threads exit and reported at exit.
+// Only built with -DBLACKJACK_PROFILE=ON, see PROFILE_SCOPE.
+
+#include "blackjack.h"
+
+#ifdef BLACKJACK_PROFILE
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+
+using namespace std;
+
+namespace blackjack {
+
+// Process totals, the threads add their counters once when they exit
+static atomic<uint64_t> g_total_calls[PROFILE_PHASES];
+static atomic<uint64_t> g_total_ticks[PROFILE_PHASES];
+static atomic<int> g_total_threads(0);
+
+// Structure that adds the thread's counters to the totals as the thread exits
+struct ProfileFlush {
+
+    bool watched;
+
+    // Constructor for ProfileFlush
+    ProfileFlush() {
+        watched = false;
+    }
+
+    ~ProfileFlush() {
+        for (int p = 0; p < PROFILE_PHASES; p++) {
+            g_total_calls[p].fetch_add(g_profile.calls[p], memory_order_relaxed);
+            g_total_ticks[p].fetch_add(g_profile.ticks[p], memory_order_relaxed);
+        }
+        g_total_threads.fetch_add(1, memory_order_relaxed);
+    }
+};
+
+static thread_local ProfileFlush t_profile_flush;
+
+// Called on a thread's first call of each phase, the first one creates the thread's flush
+void watchProfileThread() {
+
+    t_profile_flush.watched = true;
+}
+
+// Writes the report as text, one line per phase that was entered
+static void writeProfileText(FILE* out, double ticksPerNs, double seconds) {
+
+    uint64_t roundTicks = g_total_ticks[PHASE_ROUND].load();
+    fprintf(out, "profile: %.2f s, %d threads, %s at %.3f ticks/ns\n", seconds, g_total_threads.load(),
+#if defined(__x86_64__) || defined(__i386__)
+            "cycle counter",
+#else
+            "steady clock",
+#endif
+            ticksPerNs);
+    fprintf(out, "%-10s %14s %10s %12s %9s\n", "phase", "calls", "ns/call", "total ms", "of round");
+    for (int p = 0; p < PROFILE_PHASES; p++) {
+        uint64_t calls = g_total_calls[p].load();
+        uint64_t ticks = g_total_ticks[p].load();
+        if (calls == 0) {
+            continue;
+        }
+        double ns = ticks / ticksPerNs;
+        fprintf(out, "%-10s %14llu %10.1f %12.1f", PROFILE_PHASE_NAMES[p].c_str(), (unsigned long long)calls,
+                ns / calls, ns / 1e6);
+        if (roundTicks > 0) {
+            fprintf(out, " %8.1f%%", 100.0 * ticks / roundTicks);
+        }
+        fprintf(out, "\n");
+    }
+}
+
+// Writes the report as one JSON object
+static void writeProfileJson(FILE* out, double ticksPerNs, double seconds) {
+
+    fprintf(out, "{\"seconds\":%.6f,\"threads\":%d,\"ticksPerNs\":%.6f,\"phases\":{", seconds,
+            g_total_threads.load(), ticksPerNs);
+    for (int p = 0; p < PROFILE_PHASES; p++) {
+        uint64_t ticks = g_total_ticks[p].load();
+        fprintf(out, "%s\"%s\":{\"calls\":%llu,\"ticks\":%llu,\"ns\":%.0f}", p ? "," : "",
+                PROFILE_PHASE_NAMES[p].c_str(), (unsigned long long)g_total_calls[p].load(),
+                (unsigned long long)ticks, ticks / ticksPerNs);
+    }
+    fprintf(out, "}}\n");
+}
+
+// Structure that notes when the program started and writes the report when it exits. Statics
+// are destroyed after the main thread's thread locals, so every thread has been added by then.
+// BLACKJACK_PROFILE_REPORT picks text (default), json or none, BLACKJACK_PROFILE_FILE a file
+// to write it to instead of stderr.
+struct ProfileReport {
+
+    uint64_t startTicks;
+    chrono::steady_clock::time_point startTime;
+
+    // Constructor for ProfileReport
+    ProfileReport() {
+        startTicks = profileTicks();
+        startTime = chrono::steady_clock::now();
+    }
+
+    ~ProfileReport() {
+        const char* format = getenv("BLACKJACK_PROFILE_REPORT");
+        string kind = (format != nullptr) ? format : "text";
+        if (kind == "none") {
+            return;
+        }
+        // The clock rate comes from the whole run, the ticks against the wall clock
+        double ns = (double)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - startTime).count();
+        double ticksPerNs = (ns > 0) ? (profileTicks() - startTicks) / ns : 1;
+
+        const char* path = getenv("BLACKJACK_PROFILE_FILE");
+        FILE* out = (path != nullptr) ? fopen(path, "w") : stderr;
+        if (out == nullptr) {
+            fprintf(stderr, "%s: cannot write the profile\n", path);
+            return;
+        }
+        if (kind == "json") {
+            writeProfileJson(out, ticksPerNs, ns / 1e9);
+        }
+        else {
+            writeProfileText(out, ticksPerNs, ns / 1e9);
+        }
+        if (out != stderr) {
+            fclose(out);
+        }
+    }
+};
+
+static ProfileReport g_profile_report;
+
+} // namespace blackjack
+
+#endif // BLACKJACK_PROFILE
@@ -0,0 +1,422 @@
+// Line protocol for bots: many tables driven over one command stream, answers as JSON lines
+
+#include "blackjack.h"
+
+#include <cstdlib>
+#include <istream>
+
+using namespace std;
+
+namespace blackjack {
+
+// Writes the first cards of a hand as a JSON array of card names, e.g. ["QH","7S"]
+static void writeCards(Renderer& out, const CardArray& hand, int shown) {
+
+    out << '[';
+    for (int i = 0; i < shown; i++) {
+        if (i > 0) {
+            out << ',';
+        }
+        Card card = hand.cards[i];
+        out << '"' << RANK[cardRank(card) - 1] << SUIT[cardSuit(card)] << '"';
+    }
+    out << ']';
+}
+
+// Writes the fields every event of a table starts with
+static void writeHead(Renderer& out, int t, const ProtocolTable& table, const char* event) {
+
+    out << "{\"table\":" << t << ",\"round\":" << table.rounds << ",\"event\":\"" << event << '"';
+}
+
+// Writes the count fields, the running count and the true count of the cards the bot has seen.
+// While the dealer's hole card is face down its tag is left out and it counts as still in the
+// shoe, so the count doesn't give the hole card away. After a reshuffle during the round the
+// new count never had it.
+static void writeCount(Renderer& out, const ProtocolTable& table, bool holeHidden) {
+
+    Shoe seen = table.shoe;
+    if (holeHidden && table.holeCounted) {
+        seen.runningCount -= COUNT_TAGS[seen.countSystem][cardRank(table.dealerHand.cards[1])];
+        seen.nextCard--;
+    }
+    out << ",\"count\":" << seen.runningCount << ",\"true\":" << fixedNumber(trueCount(seen), 2);
+}
+
+// Deals a card to one of the player's hands. A reshuffle takes the hole card out of the count.
+static void drawPlayerCard(ProtocolTable& table, CardArray& hand) {
+
+    if (drawCard(table.shoe, hand, table.rng)) {
+        table.holeCounted = false;
+    }
+}
+
+// Writes an error line, for a table or (t < 0) for the stream
+static void writeError(Renderer& out, int t, const char* error) {
+
+    out << "{\"table\":" << t << ",\"event\":\"error\",\"error\":\"" << error << "\"}\n";
+}
+
+// Writes the state of a table waiting for the bot: the insurance question or the decision on
+// the current hand, with the letters of the commands that are allowed right now
+static void writeState(const ProtocolSession& session, Renderer& out, int t, const ProtocolTable& table) {
+
+    const PlayerHands& player = table.player;
+    bool insurance = (table.phase == TABLE_INSURANCE);
+    writeHead(out, t, table, insurance ? "insurance" : "decide");
+    out << ",\"hand\":" << table.current << ",\"hands\":[";
+    for (int h = 0; h < player.count; h++) {
+        const CardArray& hand = player.hands[h];
+        out << (h > 0 ? ",{\"cards\":" : "{\"cards\":");
+        writeCards(out, hand, hand.usedCards);
+        out << ",\"score\":" << hand.score << ",\"soft\":" << (hand.soft ? "true" : "false")
+            << ",\"bet\":" << player.bets[h] << '}';
+    }
+    out << "],\"dealer\":";
+    writeCards(out, table.dealerHand, 1);
+
+    if (insurance) {
+        out << ",\"options\":\"yn\"";
+    }
+    else {
+        int h = table.current;
+        bool canSplit = canSplitHand(player, h, session.rules);
+        bool canDouble = canDoubleHand(player, h, session.rules);
+        bool canSurrender = canSurrenderHand(player, h, session.rules);
+        out << ",\"options\":\"hs" << (canDouble ? "d" : "") << (canSplit ? "p" : "") << (canSurrender ? "r" : "") << '"';
+        int advice = strategyDecision(*session.strategy, player.hands[h], upCardValue(table.dealerHand),
+                                      canSplit, canDouble, canSurrender);
+        out << ",\"advice\":\"" << ACTION_CODES[advice] << '"';
+    }
+    writeCount(out, table, true);
+    out << "}\n";
+}
+
+// Settles the round, lets the dealer draw if a hand is still standing and writes the result.
+// natural is set when the round ended at the peek, before the player acted.
+static void finishRound(const ProtocolSession& session, Renderer& out, int t, ProtocolTable& table, bool natural) {
+
+    PlayerHands& player = table.player;
+    CardArray& dealerHand = table.dealerHand;
+    const Rules& rules = session.rules;
+    double nets[MAX_SPLIT_HANDS];
+    const char* outcomes[MAX_SPLIT_HANDS];
+    double net = 0;
+
+    // Insurance was settled when the dealer peeked
+    if (player.insurance > 0) {
+        net += dealerHand.blackjack ? 2 * player.insurance : -player.insurance;
+    }
+
+    if (natural) {
+        const CardArray& first = player.hands[0];
+        nets[0] = settleHand(first.score, first.blackjack, dealerHand.score, dealerHand.blackjack, player.bets[0], rules);
+        outcomes[0] = (nets[0] > 0) ? "blackjack" : (nets[0] < 0) ? "lose" : "push";
+    }
+    else if (player.surrendered) {
+        nets[0] = -SURRENDER_LOSS * player.bets[0];
+        outcomes[0] = "surrender";
+    }
+    else {
+        // Dealer only plays out the round if a hand is still standing
+        bool dealerPlays = false;
+        for (int h = 0; h < player.count; h++) {
+            dealerPlays = dealerPlays || !player.hands[h].bust;
+        }
+        while (dealerPlays && dealerHits(dealerHand, rules)) {
+            drawCard(table.shoe, dealerHand, table.rng);
+        }
+        for (int h = 0; h < player.count; h++) {
+            const CardArray& hand = player.hands[h];
+            nets[h] = settleHand(hand.score, false, dealerHand.score, false, player.bets[h], rules);
+            outcomes[h] = hand.bust ? "bust" : (nets[h] > 0) ? "win" : (nets[h] < 0) ? "lose" : "push";
+        }
+    }
+
+    writeHead(out, t, table, "result");
+    out << ",\"hands\":[";
+    for (int h = 0; h < player.count; h++) {
+        const CardArray& hand = player.hands[h];
+        out << (h > 0 ? ",{\"cards\":" : "{\"cards\":");
+        writeCards(out, hand, hand.usedCards);
+        out << ",\"score\":" << hand.score << ",\"bet\":" << player.bets[h]
+            << ",\"outcome\":\"" << outcomes[h] << "\",\"net\":" << nets[h] << '}';
+        net += nets[h];
+    }
+    table.net += net;
+    out << "],\"dealer\":";
+    writeCards(out, dealerHand, dealerHand.usedCards);
+    out << ",\"dealerScore\":" << dealerHand.score << ",\"insurance\":" << player.insurance
+        << ",\"net\":" << net << ",\"total\":" << table.net;
+    writeCount(out, table, false);
+    out << "}\n";
+    table.phase = TABLE_IDLE;
+}
+
+// Moves on to the next hand that needs a decision and asks for it, or ends the round
+// once every hand is done. Hands made by a split get their second card here.
+static void nextDecision(const ProtocolSession& session, Renderer& out, int t, ProtocolTable& table) {
+
+    PlayerHands& player = table.player;
+    while (table.current < player.count) {
+        CardArray& hand = player.hands[table.current];
+        if (hand.usedCards == 1) {
+            drawPlayerCard(table, hand);
+        }
+        // Split Aces get one card each, 21 stands by itself
+        if (!player.splitAces[table.current] && hand.score < BLACKJACK) {
+            writeState(session, out, t, table);
+            return;
+        }
+        table.current++;
+    }
+    finishRound(session, out, t, table, false);
+}
+
+// The dealer peeks once insurance is settled, a blackjack on either side ends the round
+static void peekRound(const ProtocolSession& session, Renderer& out, int t, ProtocolTable& table) {
+
+    if (table.dealerHand.blackjack || table.player.hands[0].blackjack) {
+        finishRound(session, out, t, table, true);
+        return;
+    }
+    table.phase = TABLE_PLAYING;
+    table.current = 0;
+    nextDecision(session, out, t, table);
+}
+
+// Deals a new round with the given bet, shuffling first if the cut card came out
+static void startRound(const ProtocolSession& session, Renderer& out, int t, ProtocolTable& table, double bet) {
+
+    reshuffleAtCutCard(table.shoe, table.rng);
+    resetHands(table.player);
+    clearHand(table.dealerHand);
+    table.player.bets[0] = bet;
+    table.rounds++;
+
+    // Two cards each, alternating like the interactive game
+    CardArray& first = table.player.hands[0];
+    drawCard(table.shoe, first, table.rng);
+    drawCard(table.shoe, table.dealerHand, table.rng);
+    drawCard(table.shoe, first, table.rng);
+    table.holeCounted = !drawCard(table.shoe, table.dealerHand, table.rng);
+
+    if (upCardValue(table.dealerHand) == 1) {
+        table.phase = TABLE_INSURANCE;
+        writeState(session, out, t, table);
+        return;
+    }
+    peekRound(session, out, t, table);
+}
+
+// Plays a decision on the current hand, returns false if it isn't allowed right now
+static bool playAction(const ProtocolSession& session, Renderer& out, int t, ProtocolTable& table, int action) {
+
+    PlayerHands& player = table.player;
+    int h = table.current;
+    CardArray& hand = player.hands[h];
+
+    if ((action == DOUBLE && !canDoubleHand(player, h, session.rules)) ||
+        (action == SPLIT && !canSplitHand(player, h, session.rules)) ||
+        (action == SURRENDER && !canSurrenderHand(player, h, session.rules))) {
+        return false;
+    }
+    if (player.actionCount < MAX_ROUND_ACTIONS) {
+        player.actions[player.actionCount++] = (unsigned char)action;
+    }
+
+    if (action == SURRENDER) {
+        player.surrendered = true;
+        finishRound(session, out, t, table, false);
+        return true;
+    }
+    if (action == STAND) {
+        table.current++;
+    }
+    else if (action == SPLIT) {
+        splitHand(player, h);
+        drawPlayerCard(table, hand);
+    }
+    else if (action == DOUBLE) {
+        player.bets[h] *= 2;
+        drawPlayerCard(table, hand);
+        table.current++;
+    }
+    else {
+        drawPlayerCard(table, hand);
+    }
+    nextDecision(session, out, t, table);
+    return true;
+}
+
+// Decision from a command word: the interactive game's letters or the full word
+static int actionByName(const string& word) {
+
+    if (word == "h" || word == "hit") return HIT;
+    if (word == "s" || word == "stand") return STAND;
+    if (word == "d" || word == "double") return DOUBLE;
+    if (word == "p" || word == "split") return SPLIT;
+    if (word == "r" || word == "surrender") return SURRENDER;
+    return -1;
+}
+
+// Opens a table with a freshly shuffled shoe. Table t always uses stream t of the seed,
+// so its cards don't depend on how the bot interleaves its tables.
+static void openTable(const ProtocolSession& session, int t, ProtocolTable& table) {
+
+    getNewDeck(table.shoe, session.rules.numDecks, session.penetration);
+    setCountSystem(table.shoe, session.countSystem);
+    seedRng(table.rng, session.rngKind, session.seed, (uint64_t)t);
+    shuffleDeck(table.shoe, table.rng);
+    table.phase = TABLE_IDLE;
+    table.current = 0;
+    table.rounds = 0;
+    table.net = 0;
+}
+
+// Handles one line of input. Commands are "<table> <command> [argument]":
+//   deal [bet]         deal a round (opens the table on first use)
+//   h s d p r          hit, stand, double, split, surrender (or the full words)
+//   y n                take or decline insurance
+//   state              repeat the question the table is waiting on
+//   close              close the table and report its totals
+// "quit" ends the session, empty lines and lines starting with # are skipped.
+// Returns false once the session should end.
+bool protocolCommand(ProtocolSession& session, const string& line, Renderer& out) {
+
+    // Split the line into up to three words
+    string words[3];
+    int count = 0;
+    size_t pos = 0;
+    while (count < 3) {
+        size_t start = line.find_first_not_of(" \t\r", pos);
+        if (start == string::npos) {
+            break;
+        }
+        size_t end = line.find_first_of(" \t\r", start);
+        if (end == string::npos) {
+            end = line.size();
+        }
+        words[count++].assign(line, start, end - start);
+        pos = end;
+    }
+    if (count == 0 || words[0][0] == '#') {
+        return true;
+    }
+    if (words[0] == "quit") {
+        return false;
+    }
+
+    char* end = nullptr;
+    long t = strtol(words[0].c_str(), &end, 10);
+    if (*end != '\0' || t < 0 || t >= MAX_PROTOCOL_TABLES) {
+        writeError(out, -1, "expected a table number (0-4095) or quit");
+        return true;
+    }
+    if (count < 2) {
+        writeError(out, (int)t, "missing command");
+        return true;
+    }
+    if ((size_t)t >= session.tables.size()) {
+        session.tables.resize(t + 1);
+    }
+    ProtocolTable& table = session.tables[t];
+    const string& command = words[1];
+
+    if (command == "close") {
+        if (table.phase != TABLE_CLOSED) {
+            writeHead(out, (int)t, table, "closed");
+            out << ",\"total\":" << table.net << "}\n";
+            freeShoe(table.shoe);
+            table.phase = TABLE_CLOSED;
+        }
+        return true;
+    }
+    if (table.phase == TABLE_CLOSED) {
+        openTable(session, (int)t, table);
+    }
+
+    if (command == "deal") {
+        double bet = (count > 2) ? atof(words[2].c_str()) : 1;
+        if (table.phase != TABLE_IDLE) {
+            writeError(out, (int)t, "round in play");
+        }
+        else if (!(bet > 0) || bet > MAX_PROTOCOL_BET) {
+            writeError(out, (int)t, "bet must be positive and at most 1e9");
+        }
+        else {
+            startRound(session, out, (int)t, table, bet);
+        }
+    }
+    else if (command == "state") {
+        if (table.phase == TABLE_IDLE) {
+            writeHead(out, (int)t, table, "idle");
+            out << ",\"total\":" << table.net;
+            writeCount(out, table, false);
+            out << "}\n";
+        }
+        else {
+            writeState(session, out, (int)t, table);
+        }
+    }
+    else if (command == "y" || command == "n" || command == "yes" || command == "no") {
+        if (table.phase != TABLE_INSURANCE) {
+            writeError(out, (int)t, "no insurance offered");
+        }
+        else {
+            if (command[0] == 'y') {
+                table.player.insurance = INSURANCE_BET * table.player.bets[0];
+            }
+            peekRound(session, out, (int)t, table);
+        }
+    }
+    else {
+        int action = actionByName(command);
+        if (action < 0) {
+            writeError(out, (int)t, "unknown command");
+        }
+        else if (table.phase != TABLE_PLAYING) {
+            writeError(out, (int)t, "no decision pending");
+        }
+        else if (!playAction(session, out, (int)t, table, action)) {
+            writeError(out, (int)t, "action not allowed");
+        }
+    }
+    return true;
+}
+
+// Frees the shoes of every open table
+void closeTables(ProtocolSession& session) {
+
+    for (ProtocolTable& table : session.tables) {
+        if (table.phase != TABLE_CLOSED) {
+            freeShoe(table.shoe);
+            table.phase = TABLE_CLOSED;
+        }
+    }
+}
+
+// Reads commands until quit or the end of the input. Answers are collected in the frame
+// and written whenever no more input is waiting, so a bot that sends its decisions for
+// many tables at once gets all the answers in one write.
+int runProtocol(ProtocolSession& session, istream& in, Renderer& out) {
+
+    out << "{\"event\":\"ready\",\"rules\":\"" << rulesName(session.rules) << "\",\"decks\":"
+        << session.rules.numDecks << ",\"count\":\"" << COUNT_NAMES[session.countSystem] << "\"}\n";
+    flushFrame(out);
+
+    string line;
+    while (getline(in, line)) {
+        if (!protocolCommand(session, line, out)) {
+            break;
+        }
+        if (in.rdbuf()->in_avail() <= 0) {
+            flushFrame(out);
+        }
+    }
+    flushFrame(out);
+    closeTables(session);
+    return 0;
+}
+
+} // namespace blackjack
@@ -0,0 +1,164 @@
+// Rendering: console text built into one buffer per frame from precomputed glyph tables
+
+#include "blackjack.h"
+
+#include <charconv>
+
+using namespace std;
+
+namespace blackjack {
+
+// Escape codes of the styles in the colored modes, in Style index order
+const char* const STYLE_CODES[STYLE_COUNT] = {
+    "\x1B[0m", "\x1B[31m", "\x1B[32m", "\x1B[33m", "\x1B[34m", "\x1B[35m", "\x1B[36m", "\x1B[1m"
+};
+
+// Suit symbols by suit index (Spades, Hearts, Diamonds, Clubs)
+const char* const UNICODE_SUITS[] = { "♠", "♥", "♦", "♣" };
+
+// Room reserved for a frame up front, a round rarely needs more
+const size_t FRAME_RESERVE = 8192;
+
+// Switches the output mode and rebuilds the palette and the card glyphs for it.
+// Text already in the frame is kept.
+void setRenderMode(Renderer& renderer, int mode) {
+
+    renderer.mode = mode;
+    renderer.frame.reserve(FRAME_RESERVE);
+    bool colors = (mode == RENDER_ANSI || mode == RENDER_UNICODE);
+    for (int s = 0; s < STYLE_COUNT; s++) {
+        renderer.palette[s] = colors ? STYLE_CODES[s] : "";
+    }
+    const string& normal = renderer.palette[STYLE_NORMAL.index];
+
+    for (int code = 0; code < CARD_CODES; code++) {
+        Card card;
+        card.code = (unsigned char)code;
+        int rank = cardRank(card);
+        int suit = cardSuit(card);
+        if (rank < 1 || rank > MAX_CARDS_IN_SUIT) {
+            renderer.cardGlyph[code].clear();
+            renderer.nameGlyph[code].clear();
+            continue;
+        }
+        // Hearts and Diamonds are red
+        const string& color = renderer.palette[(suit == 1 || suit == 2) ? STYLE_RED.index : STYLE_NORMAL.index];
+        string symbol = (mode == RENDER_UNICODE) ? UNICODE_SUITS[suit] : SUIT[suit];
+        renderer.cardGlyph[code] = "[" + color + RANK[rank - 1] + symbol + normal + "] ";
+
+        string name = cardName(card);
+        renderer.nameGlyph[code] = string(4 - name.size(), ' ') + name;
+    }
+    renderer.holeGlyph = "[" + renderer.palette[STYLE_CYAN.index] + "??" + normal + "]";
+}
+
+// Render mode from its name, -1 if unknown
+int renderModeByName(const string& name) {
+
+    for (int m = 0; m < RENDER_MODES; m++) {
+        if (name == RENDER_NAMES[m]) {
+            return m;
+        }
+    }
+    return -1;
+}
+
+// Writes the finished frame in one go and starts the next one
+void flushFrame(Renderer& renderer) {
+
+    PROFILE_SCOPE(PHASE_RENDER);
+    if (!renderer.frame.empty()) {
+        fwrite(renderer.frame.data(), 1, renderer.frame.size(), renderer.out);
+        fflush(renderer.out);
+        renderer.frame.clear();
+    }
+}
+
+// Adds the cards of a hand. HIDDEN shows the first card and a face down card.
+void renderHand(Renderer& renderer, const CardArray& hand, int display) {
+
+    if (renderer.mode == RENDER_NULL) {
+        return;
+    }
+    if (display == HIDDEN) {
+        renderer.frame += renderer.cardGlyph[hand.cards[0].code];
+        renderer.frame += renderer.holeGlyph;
+        return;
+    }
+    for (int i = 0; i < hand.usedCards; i++) {
+        renderer.frame += renderer.cardGlyph[hand.cards[i].code];
+    }
+}
+
+Renderer& operator<<(Renderer& renderer, const char* text) {
+    if (renderer.mode != RENDER_NULL) {
+        renderer.frame += text;
+    }
+    return renderer;
+}
+
+Renderer& operator<<(Renderer& renderer, const string& text) {
+    if (renderer.mode != RENDER_NULL) {
+        renderer.frame += text;
+    }
+    return renderer;
+}
+
+Renderer& operator<<(Renderer& renderer, char c) {
+    if (renderer.mode != RENDER_NULL) {
+        renderer.frame += c;
+    }
+    return renderer;
+}
+
+Renderer& operator<<(Renderer& renderer, int value) {
+    if (renderer.mode != RENDER_NULL) {
+        char digits[16];
+        to_chars_result end = to_chars(digits, digits + sizeof(digits), value);
+        renderer.frame.append(digits, end.ptr);
+    }
+    return renderer;
+}
+
+Renderer& operator<<(Renderer& renderer, long long value) {
+    if (renderer.mode != RENDER_NULL) {
+        char digits[24];
+        to_chars_result end = to_chars(digits, digits + sizeof(digits), value);
+        renderer.frame.append(digits, end.ptr);
+    }
+    return renderer;
+}
+
+// Doubles without a Number are written like the stream default, 6 significant digits
+Renderer& operator<<(Renderer& renderer, double value) {
+    if (renderer.mode != RENDER_NULL) {
+        char digits[32];
+        int length = snprintf(digits, sizeof(digits), "%g", value);
+        renderer.frame.append(digits, length);
+    }
+    return renderer;
+}
+
+Renderer& operator<<(Renderer& renderer, Style style) {
+    if (renderer.mode != RENDER_NULL) {
+        renderer.frame += renderer.palette[style.index];
+    }
+    return renderer;
+}
+
+Renderer& operator<<(Renderer& renderer, Number number) {
+    if (renderer.mode != RENDER_NULL) {
+        char digits[64];
+        int length = snprintf(digits, sizeof(digits), number.sign ? "%+.*f" : "%.*f", number.decimals, number.value);
+        // A number too wide for the buffer is cut off, snprintf returns the length it wanted
+        if (length > (int)sizeof(digits) - 1) {
+            length = (int)sizeof(digits) - 1;
+        }
+        if (length > 0) {
+            renderer.frame.append(digits, length);
+        }
+    }
+    return renderer;
+}
+
+} // namespace blackjack
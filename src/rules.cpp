@@ -0,0 +1,101 @@
+// Table rules: payouts, descriptions and the command line options both programs share
+
+#include "blackjack.h"
+
+#include <cstdlib>
+#include <sstream>
+
+using namespace std;
+
+namespace blackjack {
+
+// Reads a blackjack payout written as a ratio, e.g. "3:2" or "6:5"
+bool parsePayout(const string& text, double& pays) {
+
+    size_t colon = text.find(':');
+    if (colon == string::npos) {
+        return false;
+    }
+    double win = atof(text.substr(0, colon).c_str());
+    double bet = atof(text.substr(colon + 1).c_str());
+    if (win <= 0 || bet <= 0) {
+        return false;
+    }
+    pays = win / bet;
+    return true;
+}
+
+// Short description of the rules, e.g. "S17, blackjack pays 1.5, DAS, split to 4 hands, late surrender"
+string rulesName(const Rules& rules) {
+
+    ostringstream name;
+    name << (rules.hitSoft17 ? "H17" : "S17") << ", blackjack pays " << rules.blackjackPays;
+    if (rules.doubleAfterSplit) {
+        name << ", DAS";
+    }
+    if (rules.maxHands > 1) {
+        name << ", split to " << rules.maxHands << " hands";
+    }
+    else {
+        name << ", no splits";
+    }
+    if (rules.surrender) {
+        name << ", late surrender";
+    }
+    return name.str();
+}
+
+// Reads the table rule option at argv[i], and its value if it takes one, into rules.
+// Returns false if argv[i] isn't a rule option. A bad value sets error.
+bool readRulesOption(int argc, char* argv[], int& i, Rules& rules, string& error) {
+
+    string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--decks" && hasValue) {
+        rules.numDecks = atoi(argv[++i]);
+    }
+    else if (arg == "--h17") {
+        rules.hitSoft17 = true;
+    }
+    else if (arg == "--blackjack-pays" && hasValue) {
+        if (!parsePayout(argv[++i], rules.blackjackPays)) {
+            error = "Blackjack payout must be a ratio like 3:2 or 6:5";
+        }
+    }
+    else if (arg == "--no-das") {
+        rules.doubleAfterSplit = false;
+    }
+    else if (arg == "--max-hands" && hasValue) {
+        rules.maxHands = atoi(argv[++i]);
+    }
+    else if (arg == "--no-surrender") {
+        rules.surrender = false;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+// Checks the rules can be dealt: 1 to 8 decks and room for the split hands
+bool checkRules(const Rules& rules, string& error) {
+
+    if (rules.maxHands < 1 || rules.maxHands > MAX_SPLIT_HANDS) {
+        error = "Pairs can be split into 1 to " + to_string(MAX_SPLIT_HANDS) + " hands";
+        return false;
+    }
+    if (rules.numDecks < 1 || rules.numDecks > MAX_DECKS_IN_SHOE) {
+        error = "Shoe must have 1 to " + to_string(MAX_DECKS_IN_SHOE) + " decks";
+        return false;
+    }
+    return true;
+}
+
+// Usage text for the rule options, for the programs' usage messages
+string rulesUsage() {
+
+    return " [--decks 1-" + to_string(MAX_DECKS_IN_SHOE) + "] [--h17] [--blackjack-pays 3:2|6:5] [--no-das]"
+           " [--max-hands 1-" + to_string(MAX_SPLIT_HANDS) + "] [--no-surrender]";
+}
+
+} // namespace blackjack
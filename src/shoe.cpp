@@ -0,0 +1,475 @@
+// Shoes and random numbers: building, shuffling and dealing from a shoe, the generator
+// backends, the batched shuffle engine with its self-test, and the card count
+
+#include "blackjack.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+namespace blackjack {
+
+// Display text for a card, e.g. "10H"
+string cardName(Card card) {
+    return RANK[cardRank(card) - 1] + SUIT[cardSuit(card)];
+}
+
+
+// Function for creating a new shoe of numDecks decks of 52 cards.
+// The cut card is placed after the given fraction (penetration) of the shoe.
+void getNewDeck(Shoe& shoe, int numDecks, double penetration) {
+
+    // Initialize variables for indexing cards and suits
+    int cardIndex = 0, suitIndex = 0, suit = 0;
+
+    // Set the size of the shoe and create an array, this is the only allocation
+    shoe.numDecks = numDecks;
+    shoe.size = numDecks * MAX_DECK_SIZE;
+    shoe.cards = new Card[shoe.size];
+    shoe.nextCard = 0;
+    resetCount(shoe);
+
+    // Cut card can't be in front of the first card or behind the last one
+    shoe.cutCard = (int)(shoe.size * penetration);
+    if (shoe.cutCard < 1) {
+        shoe.cutCard = 1;
+    }
+    if (shoe.cutCard > shoe.size) {
+        shoe.cutCard = shoe.size;
+    }
+
+    // create 52 cards for every deck
+    while (cardIndex < shoe.size) {
+        // loop through 13 cards with first suit
+        for (suitIndex = 0; suitIndex < MAX_CARDS_IN_SUIT; suitIndex++, cardIndex++) {
+            // assign rank and suit, value and description come from the rank
+            shoe.cards[cardIndex] = makeCard(RANK_VALUE[suitIndex], suit);
+        }
+        // change suit after 13 cards, start over after clubs for the next deck
+        suit = (suit + 1) % 4;
+    }
+}
+
+// Delete the cards of the shoe
+void freeShoe(Shoe& shoe) {
+
+    delete[] shoe.cards;
+    shoe.cards = nullptr;
+    shoe.size = 0;
+    shoe.nextCard = 0;
+}
+
+// Fisher-Yates: every item swaps with an item at or before it, so all orders are equally likely.
+// Shared by shuffleDeck and the shuffle self-test so the test checks the real code path.
+template <typename T>
+void fisherYates(T* items, int count, Rng& rng) {
+
+    // Temp holder for swapping items
+    T temp;
+    // Variable for swapping random item index
+    int randomItem = 0;
+
+    // Randomize (shuffle) the items, back to front
+    for (int i = count - 1; i > 0; i--) {
+        randomItem = randomBelow(rng, i + 1);
+        temp = items[i];
+        items[i] = items[randomItem];
+        items[randomItem] = temp;
+    }
+}
+
+// Function for randomizing the cards in the shoe (Shuffling).
+// Shuffles in place and starts dealing from the top again.
+void shuffleDeck(Shoe& shoe, Rng& rng) {
+
+    PROFILE_SCOPE(PHASE_SHUFFLE);
+    fisherYates(shoe.cards, shoe.size, rng);
+    shoe.nextCard = 0;
+    resetCount(shoe);
+}
+
+// Called before each round, reshuffles once the cut card has come out.
+// Returns true when the shoe was reshuffled.
+bool reshuffleAtCutCard(Shoe& shoe, Rng& rng) {
+
+    if (shoe.nextCard >= shoe.cutCard) {
+        shuffleDeck(shoe, rng);
+        return true;
+    }
+    return false;
+}
+
+// Rotates a 64 bit value left, used by the random number generators
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// splitmix64 finalizer, turns any 64 bit value into a well mixed one
+static inline uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// One step of xoshiro256**
+static inline uint64_t xoshiroNext(Rng& rng) {
+
+    uint64_t result = rotl(rng.s[1] * 5, 7) * 9;
+    uint64_t t = rng.s[1] << 17;
+
+    rng.s[2] ^= rng.s[0];
+    rng.s[3] ^= rng.s[1];
+    rng.s[1] ^= rng.s[2];
+    rng.s[0] ^= rng.s[3];
+    rng.s[2] ^= t;
+    rng.s[3] = rotl(rng.s[3], 45);
+
+    return result;
+}
+
+// One step of PCG32 (XSH-RR), s[0] is the state and s[1] the odd stream increment
+static inline uint32_t pcgNext(Rng& rng) {
+
+    uint64_t old = rng.s[0];
+    rng.s[0] = old * 6364136223846793005ULL + rng.s[1];
+    uint32_t xorShifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (xorShifted >> rot) | (xorShifted << ((32 - rot) & 31));
+}
+
+// One step of splitmix64, s[0] is the counter and s[1] the odd stream gamma
+static inline uint64_t splitmixNext(Rng& rng) {
+
+    rng.s[0] += rng.s[1];
+    return mix64(rng.s[0]);
+}
+
+// Seeds the generator from a seed and a stream number. Different streams of the same
+// seed are independent: xoshiro jumps 2^128 steps per stream, pcg and splitmix
+// use a different increment (gamma) per stream.
+void seedRng(Rng& rng, int kind, uint64_t seed, uint64_t stream) {
+
+    rng.kind = kind;
+
+    // Expand the seed into the state with splitmix64
+    uint64_t x = seed;
+    for (int i = 0; i < 4; i++) {
+        x += 0x9E3779B97F4A7C15ULL;
+        rng.s[i] = mix64(x);
+    }
+
+    if (kind == RNG_PCG) {
+        rng.s[1] = (mix64(stream ^ 0x5851F42D4C957F2DULL) << 1) | 1;
+        pcgNext(rng);
+        return;
+    }
+    if (kind == RNG_SPLITMIX) {
+        rng.s[1] = mix64(stream + 0x9E3779B97F4A7C15ULL) | 1;
+        return;
+    }
+
+    // Jump ahead once per stream
+    const uint64_t JUMP[] = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+                              0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+    for (uint64_t n = 0; n < stream; n++) {
+        uint64_t t[4] = { 0, 0, 0, 0 };
+        for (int i = 0; i < 4; i++) {
+            for (int b = 0; b < 64; b++) {
+                if (JUMP[i] & (1ULL << b)) {
+                    for (int j = 0; j < 4; j++) {
+                        t[j] ^= rng.s[j];
+                    }
+                }
+                xoshiroNext(rng);
+            }
+        }
+        for (int j = 0; j < 4; j++) {
+            rng.s[j] = t[j];
+        }
+    }
+}
+
+// Returns the next 64 random bits from the selected backend
+uint64_t nextRandom(Rng& rng) {
+
+    if (rng.kind == RNG_PCG) {
+        uint64_t high = pcgNext(rng);
+        return (high << 32) | pcgNext(rng);
+    }
+    if (rng.kind == RNG_SPLITMIX) {
+        return splitmixNext(rng);
+    }
+    return xoshiroNext(rng);
+}
+
+// Returns the next 32 random bits, one step for every backend
+uint32_t nextRandom32(Rng& rng) {
+
+    if (rng.kind == RNG_PCG) {
+        return pcgNext(rng);
+    }
+    if (rng.kind == RNG_SPLITMIX) {
+        return (uint32_t)(splitmixNext(rng) >> 32);
+    }
+    return (uint32_t)(xoshiroNext(rng) >> 32);
+}
+
+// Maps 32 random bits onto 0 to bound - 1 without modulo bias (Lemire's method).
+// The multiply picks the range, the rare values that would over-represent some
+// results are rejected and redrawn.
+template <typename Next>
+static inline int boundedRandom(Rng& rng, uint32_t bound, Next next) {
+
+    uint64_t m = (uint64_t)next(rng) * bound;
+    uint32_t low = (uint32_t)m;
+    if (low < bound) {
+        uint32_t threshold = (0u - bound) % bound;
+        while (low < threshold) {
+            m = (uint64_t)next(rng) * bound;
+            low = (uint32_t)m;
+        }
+    }
+    return (int)(m >> 32);
+}
+
+// Returns a random number from 0 to bound - 1, every value equally likely
+int randomBelow(Rng& rng, int bound) {
+
+    return boundedRandom(rng, (uint32_t)bound, nextRandom32);
+}
+
+// Looks up a random number generator backend by name, -1 if unknown
+int rngByName(const string& name) {
+
+    if (name == "xoshiro") {
+        return RNG_XOSHIRO;
+    }
+    if (name == "pcg") {
+        return RNG_PCG;
+    }
+    if (name == "splitmix") {
+        return RNG_SPLITMIX;
+    }
+    return -1;
+}
+
+// Shuffles several shoes of the same size at once, each with its own generator.
+// The loops are interleaved so the independent generators and swaps of different
+// shoes overlap in the CPU instead of running one long dependency chain.
+template <typename Next>
+static void shuffleBatchWith(Shoe* shoes, Rng* rngs, int count, Next next) {
+
+    int size = shoes[0].size;
+    for (int i = size - 1; i > 0; i--) {
+        for (int k = 0; k < count; k++) {
+            int randomCard = boundedRandom(rngs[k], (uint32_t)(i + 1), next);
+            Card temp = shoes[k].cards[i];
+            shoes[k].cards[i] = shoes[k].cards[randomCard];
+            shoes[k].cards[randomCard] = temp;
+        }
+    }
+    for (int k = 0; k < count; k++) {
+        shoes[k].nextCard = 0;
+        resetCount(shoes[k]);
+    }
+}
+
+// Batched Fisher-Yates for count shoes, all generators must use the same backend.
+// The backend is picked once here so the inner loop calls it directly.
+void shuffleBatch(Shoe* shoes, Rng* rngs, int count) {
+
+    PROFILE_SCOPE(PHASE_SHUFFLE);
+    if (rngs[0].kind == RNG_PCG) {
+        shuffleBatchWith(shoes, rngs, count, pcgNext);
+    }
+    else if (rngs[0].kind == RNG_SPLITMIX) {
+        shuffleBatchWith(shoes, rngs, count, [](Rng& rng) { return (uint32_t)(splitmixNext(rng) >> 32); });
+    }
+    else {
+        shuffleBatchWith(shoes, rngs, count, [](Rng& rng) { return (uint32_t)(xoshiroNext(rng) >> 32); });
+    }
+}
+
+// Probability of a chi-square value at least this large for the given degrees of
+// freedom, using the Wilson-Hilferty normal approximation (good for df above ~30)
+double chiSquarePValue(double chiSquare, double degrees) {
+
+    double scale = 2.0 / (9.0 * degrees);
+    double z = (cbrt(chiSquare / degrees) - (1.0 - scale)) / sqrt(scale);
+    return 0.5 * erfc(z / sqrt(2.0));
+}
+
+// Entry point for --shuffle-test. Shuffles a shoe in factory order many times,
+// counts where every card ends up and checks each position against the uniform
+// distribution with a chi-square test. Prints the report and returns 1 on failure.
+int runShuffleTest(long long shuffles, int numDecks, int rngKind, uint64_t seed) {
+
+    // Cards of a multi deck shoe repeat, so each card is tracked by its factory position.
+    // fisherYates is the same routine shuffleDeck runs, only the items differ.
+    int size = numDecks * MAX_DECK_SIZE;
+    vector<int> order(size);
+    vector<long long> counts((size_t)size * size, 0);
+
+    Rng rng;
+    seedRng(rng, rngKind, seed, 0);
+
+    for (long long n = 0; n < shuffles; n++) {
+        for (int i = 0; i < size; i++) {
+            order[i] = i;
+        }
+        fisherYates(&order[0], size, rng);
+        for (int position = 0; position < size; position++) {
+            counts[(size_t)position * size + order[position]]++;
+        }
+    }
+
+    // Chi-square per position and over the whole position x card table
+    double expected = (double)shuffles / size;
+    double total = 0;
+    double worstP = 1.0;
+    int worstPosition = 0;
+    double maxDeviation = 0;
+    for (int position = 0; position < size; position++) {
+        double chi = 0;
+        for (int card = 0; card < size; card++) {
+            double diff = counts[(size_t)position * size + card] - expected;
+            chi += diff * diff / expected;
+            if (fabs(diff) / expected > maxDeviation) {
+                maxDeviation = fabs(diff) / expected;
+            }
+        }
+        total += chi;
+        double p = chiSquarePValue(chi, size - 1);
+        if (p < worstP) {
+            worstP = p;
+            worstPosition = position;
+        }
+    }
+    double degrees = (double)(size - 1) * (size - 1);
+    double pValue = chiSquarePValue(total, degrees);
+
+    // Smallest per position p value is expected to be around 1 / size even for a perfect shuffle
+    bool pass = pValue >= 0.001 && worstP * size >= 0.001;
+
+    cout << fixed;
+    cout << "shuffle self-test\n";
+    cout << "rng:            " << RNG_NAMES[rngKind] << " (seed " << seed << ")\n";
+    cout << "cards:          " << size << " (" << numDecks << " deck" << (numDecks > 1 ? "s" : "") << ")\n";
+    cout << "shuffles:       " << shuffles << "\n";
+    cout << "expected/cell:  " << setprecision(1) << expected << "\n";
+    cout << "chi-square:     " << setprecision(1) << total << " (df " << setprecision(0) << degrees << ")\n";
+    cout << "p-value:        " << setprecision(4) << pValue << "\n";
+    cout << "worst position: " << worstPosition << " (p " << worstP << ", x" << size << " positions = " << worstP * size << ")\n";
+    cout << "max deviation:  " << setprecision(2) << maxDeviation * 100 << "% of expected\n";
+    cout << "result:         " << (pass ? "PASS" : "FAIL") << endl;
+
+    return pass ? 0 : 1;
+}
+
+// Picks the counting system for the shoe and starts its count over
+void setCountSystem(Shoe& shoe, int system) {
+
+    shoe.countSystem = system;
+    resetCount(shoe);
+}
+
+// Starts the count for a freshly shuffled shoe. Balanced systems start at 0. An unbalanced
+// system (KO) starts at minus the tags of all but one deck, so its count reaches the tag
+// total of a single deck (the pivot, +4 for KO) when the whole shoe has been dealt.
+void resetCount(Shoe& shoe) {
+
+    int deckTotal = 0;
+    for (int rank = 1; rank <= MAX_CARDS_IN_SUIT; rank++) {
+        deckTotal += 4 * COUNT_TAGS[shoe.countSystem][rank];
+    }
+    shoe.runningCount = -deckTotal * (shoe.numDecks - 1);
+}
+
+// A system is balanced when the tags of a full deck add up to zero
+bool countIsBalanced(int system) {
+
+    int deckTotal = 0;
+    for (int rank = 1; rank <= MAX_CARDS_IN_SUIT; rank++) {
+        deckTotal += COUNT_TAGS[system][rank];
+    }
+    return deckTotal == 0;
+}
+
+// Count to bet on: the running count per deck left for balanced systems, never dividing
+// by less than half a deck. Unbalanced systems are played off the running count itself.
+double trueCount(const Shoe& shoe) {
+
+    if (!countIsBalanced(shoe.countSystem)) {
+        return shoe.runningCount;
+    }
+    int cardsLeft = shoe.size - shoe.nextCard;
+    if (cardsLeft < MAX_DECK_SIZE / 2) {
+        cardsLeft = MAX_DECK_SIZE / 2;
+    }
+    return shoe.runningCount * (double)MAX_DECK_SIZE / cardsLeft;
+}
+
+// Looks up a counting system by the name given on the command line, -1 if unknown
+int countByName(const string& name) {
+
+    for (int system = 0; system < COUNT_SYSTEMS; system++) {
+        if (name == COUNT_NAMES[system]) {
+            return system;
+        }
+    }
+    return -1;
+}
+
+// Reads a bet spread such as "1,2,4,8": the bets for a true count of 1 (or less), 2, 3
+// and 4 (or more). Every bet must be a positive finite number with nothing after it.
+bool parseSpread(const string& text, vector<double>& spread) {
+
+    spread.clear();
+    stringstream in(text);
+    string item;
+    while (getline(in, item, ',')) {
+        char* end = nullptr;
+        double bet = strtod(item.c_str(), &end);
+        if (end == item.c_str() || *end != '\0' || !(bet > 0) || !isfinite(bet)) {
+            return false;
+        }
+        spread.push_back(bet);
+    }
+    return !spread.empty();
+}
+
+// Bet for a true count: the first bet up to a count of 1, then one step per whole count,
+// the last bet for everything above the end of the spread
+double betForCount(const vector<double>& spread, double count) {
+
+    int step = (int)floor(count) - 1;
+    if (step < 0) {
+        step = 0;
+    }
+    if (step >= (int)spread.size()) {
+        step = (int)spread.size() - 1;
+    }
+    return spread[step];
+}
+
+// Chance of losing the whole bankroll before winning forever, for rounds with the given
+// mean and variance (all in units). Uses the diffusion approximation exp(-2 m B / v),
+// a game without an edge is ruin for sure.
+double riskOfRuin(double mean, double variance, double bankroll) {
+
+    if (mean <= 0) {
+        return 1;
+    }
+    if (variance <= 0) {
+        return 0;
+    }
+    return exp(-2 * mean * bankroll / variance);
+}
+
+} // namespace blackjack
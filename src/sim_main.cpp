@@ -0,0 +1,392 @@
+// Headless simulator: plays N hands with no prompts, records and replays hand histories, and
+// prints the strategy, dealer odds, solved strategy charts and shuffle self-test reports
+
+#include "blackjack.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+using namespace blackjack;
+
+// Sets up the seats of a multi-seat table and plays it. Seats take their strategy from the
+// comma separated policy names or strategy files in order, seats past the end of the list play
+// the main policy. Bankrolls are given the same way, seats past the end of that list get the
+// last one. Without bankrolls the seats play with no limit, with them the table plays one
+// session on one thread.
+static int runTable(long long rounds, const SimConfig& sim, int seats, const string& policyName,
+                    const string& seatPolicies, const vector<double>& seatBankrolls, int threads, uint64_t seed) {
+
+    TableConfig config;
+    config.sim = sim;
+    config.seats = seats;
+    StrategyTable loaded[MAX_SEATS];
+    size_t pos = 0;
+    for (int s = 0; s < seats; s++) {
+        config.strategy[s] = sim.strategy;
+        config.names[s] = policyName;
+        if (pos < seatPolicies.size()) {
+            size_t comma = seatPolicies.find(',', pos);
+            if (comma == string::npos) {
+                comma = seatPolicies.size();
+            }
+            string name = seatPolicies.substr(pos, comma - pos);
+            pos = comma + 1;
+            string error;
+            bool builtIn = (strategyByName(name) != nullptr);
+            config.strategy[s] = selectStrategy(name, builtIn ? string() : name, loaded[s], error);
+            if (config.strategy[s] == nullptr) {
+                cerr << error << endl;
+                return 1;
+            }
+            config.names[s] = name;
+        }
+        if (!seatBankrolls.empty()) {
+            config.bankroll[s] = seatBankrolls[min((size_t)s, seatBankrolls.size() - 1)];
+        }
+    }
+    return runTableSimulation(rounds, config, threads, seed);
+}
+
+// Sets up a comparison of the comma separated policy names or strategy files and plays it.
+// The first one is the baseline the others are measured against.
+static int runCompare(long long rounds, const SimConfig& sim, const string& policies, int threads, uint64_t seed) {
+
+    CompareConfig config;
+    config.sim = sim;
+    StrategyTable loaded[MAX_COMPARE_POLICIES];
+    size_t pos = 0;
+    while (pos <= policies.size()) {
+        size_t comma = policies.find(',', pos);
+        if (comma == string::npos) {
+            comma = policies.size();
+        }
+        string name = policies.substr(pos, comma - pos);
+        pos = comma + 1;
+        if (config.policies == MAX_COMPARE_POLICIES) {
+            cerr << "At most " << MAX_COMPARE_POLICIES << " policies can be compared" << endl;
+            return 1;
+        }
+        string error;
+        int p = config.policies;
+        bool builtIn = (strategyByName(name) != nullptr);
+        config.strategy[p] = selectStrategy(name, builtIn ? string() : name, loaded[p], error);
+        if (config.strategy[p] == nullptr) {
+            cerr << error << endl;
+            return 1;
+        }
+        config.names[p] = name;
+        config.policies++;
+    }
+    if (config.policies < 2) {
+        cerr << "Give at least two policies to compare, e.g. --compare bicycle,dealer" << endl;
+        return 1;
+    }
+    return runComparison(rounds, config, threads, seed);
+}
+
+// Run with --simulate N [--policy name] [--threads T] [--seed S] to play N hands headless.
+// --strategy FILE replaces the policy with a strategy table from a file.
+// --record FILE logs every shuffle and hand, --replay FILE reruns a log and checks it matches.
+// --seats N plays a table of N seats sharing the shoe, see runTable.
+// --compare P1,P2,... plays the policies on the same cards and reports their differences.
+// --optimize searches the advisor's targets and up card boundaries, N rounds at most per stage.
+// --precision E stops once the EV/hand interval is within +/-E units, N is then the most to play.
+int main(int argc, char* argv[])
+{
+    // Seed from the clock unless a seed is given, so runs can be repeated
+    uint64_t seed = (uint64_t)time(0);
+    int rngKind = RNG_XOSHIRO;
+
+    long long simHands = 0;
+    string policyName = "bicycle";
+    Rules rules;
+    double penetration = DEFAULT_PENETRATION;
+    int threads = (int)thread::hardware_concurrency();
+    int shuffleBatchSize = 1;
+    long long shuffleTests = 0;
+    string strategyFile;
+    bool printOnly = false;
+    bool dealerOddsOnly = false;
+    bool solveChart = false;
+    bool takeInsurance = false;
+    int countSystem = COUNT_HILO;
+    vector<double> spread;
+    double bankroll = DEFAULT_BANKROLL;
+    int dealerMode = DEALER_EXACT;
+    string recordFile;
+    string replayFile;
+    bool dumpRecords = false;
+    int seats = 0;
+    int batchKind = BATCH_AUTO;
+    string seatPolicies;
+    vector<double> seatBankrolls;
+    string comparePolicies;
+    bool optimize = false;
+    double precision = 0;
+    double confidence = DEFAULT_CONFIDENCE;
+    bool buckets = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        string error;
+        if (readRulesOption(argc, argv, i, rules, error)) {
+            if (!error.empty()) {
+                cerr << error << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--simulate" && i + 1 < argc) {
+            simHands = atoll(argv[++i]);
+        }
+        else if (arg == "--policy" && i + 1 < argc) {
+            policyName = argv[++i];
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        }
+        else if (arg == "--seed" && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--penetration" && i + 1 < argc) {
+            penetration = atof(argv[++i]);
+        }
+        else if (arg == "--rng" && i + 1 < argc) {
+            rngKind = rngByName(argv[++i]);
+        }
+        else if (arg == "--shuffle-batch" && i + 1 < argc) {
+            shuffleBatchSize = atoi(argv[++i]);
+        }
+        else if (arg == "--shuffle-test" && i + 1 < argc) {
+            shuffleTests = atoll(argv[++i]);
+        }
+        else if (arg == "--strategy" && i + 1 < argc) {
+            strategyFile = argv[++i];
+        }
+        else if (arg == "--print-strategy") {
+            printOnly = true;
+        }
+        else if (arg == "--dealer-odds") {
+            dealerOddsOnly = true;
+        }
+        else if (arg == "--solve-chart") {
+            solveChart = true;
+        }
+        else if (arg == "--insurance") {
+            takeInsurance = true;
+        }
+        else if (arg == "--count" && i + 1 < argc) {
+            countSystem = countByName(argv[++i]);
+        }
+        else if (arg == "--spread" && i + 1 < argc) {
+            if (!parseSpread(argv[++i], spread)) {
+                cerr << "Bet spread must be positive bets separated by commas, e.g. 1,2,4,8" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--bankroll" && i + 1 < argc) {
+            bankroll = atof(argv[++i]);
+        }
+        else if (arg == "--dealer" && i + 1 < argc) {
+            dealerMode = dealerModeByName(argv[++i]);
+        }
+        else if (arg == "--record" && i + 1 < argc) {
+            recordFile = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argc) {
+            replayFile = argv[++i];
+        }
+        else if (arg == "--dump") {
+            dumpRecords = true;
+        }
+        else if (arg == "--batch-eval" && i + 1 < argc) {
+            string name = argv[++i];
+            batchKind = (name == "auto") ? BATCH_AUTO : (name == BATCH_EVALUATOR_NAMES[BATCH_AVX2]) ? BATCH_AVX2
+                      : (name == BATCH_EVALUATOR_NAMES[BATCH_SCALAR]) ? BATCH_SCALAR : -2;
+        }
+        else if (arg == "--compare" && i + 1 < argc) {
+            comparePolicies = argv[++i];
+        }
+        else if (arg == "--optimize") {
+            optimize = true;
+        }
+        else if (arg == "--precision" && i + 1 < argc) {
+            precision = atof(argv[++i]);
+        }
+        else if (arg == "--confidence" && i + 1 < argc) {
+            confidence = atof(argv[++i]);
+        }
+        else if (arg == "--buckets") {
+            buckets = true;
+        }
+        else if (arg == "--seats" && i + 1 < argc) {
+            seats = atoi(argv[++i]);
+        }
+        else if (arg == "--seat-policies" && i + 1 < argc) {
+            seatPolicies = argv[++i];
+        }
+        else if (arg == "--seat-bankrolls" && i + 1 < argc) {
+            if (!parseSpread(argv[++i], seatBankrolls)) {
+                cerr << "Seat bankrolls must be positive numbers separated by commas, e.g. 500,1000" << endl;
+                return 1;
+            }
+        }
+        else {
+            simHands = -1;
+            break;
+        }
+    }
+    // A replay reruns the logged run exactly, every setting comes from the log
+    if (simHands > 0 && !replayFile.empty()) {
+        cerr << "--replay reruns the run the log holds and can't be combined with --simulate" << endl;
+        return 1;
+    }
+    if (simHands == 0 && !replayFile.empty()) {
+        return runReplay(replayFile, dumpRecords);
+    }
+    if (simHands <= 0 && shuffleTests <= 0 && !printOnly && !dealerOddsOnly && !solveChart) {
+        cerr << "Usage: " << argv[0] << " --simulate N [--record FILE] | --replay FILE [--dump] | --shuffle-test N"
+             << " | --print-strategy | --dealer-odds | --solve-chart" << endl
+             << "  [--policy bicycle|dealer|neverbust] [--strategy FILE] [--threads T] [--seed S]"
+             << " [--penetration 0-1] [--rng xoshiro|pcg|splitmix] [--shuffle-batch K]" << endl
+             << " " << rulesUsage() << " [--insurance]" << endl
+             << "  [--count hilo|ko|omega2] [--spread B1,B2,...] [--bankroll B]" << endl
+             << "  [--dealer exact|shoe|infinite|batch] [--batch-eval auto|scalar|avx2]" << endl
+             << "  [--seats 1-7] [--seat-policies P1,P2,...] [--seat-bankrolls B1,B2,...]" << endl
+             << "  [--precision E] [--confidence 0-1] [--buckets] [--compare P1,P2,...] [--optimize]" << endl;
+        return 1;
+    }
+    if (dealerMode < 0) {
+        cerr << "Unknown dealer mode (use exact, shoe, infinite or batch)" << endl;
+        return 1;
+    }
+    if (batchKind < BATCH_AUTO) {
+        cerr << "Unknown batch evaluator (use auto, scalar or avx2)" << endl;
+        return 1;
+    }
+    if (dealerMode == DEALER_BATCH && !recordFile.empty()) {
+        cerr << "The batch dealer plays many shoes in lockstep and can't be recorded" << endl;
+        return 1;
+    }
+    if (selectBatchEvaluator(batchKind) != batchKind && batchKind != BATCH_AUTO) {
+        cerr << "The " << BATCH_EVALUATOR_NAMES[batchKind] << " evaluator isn't supported here, using scalar" << endl;
+    }
+    if (countSystem < 0) {
+        cerr << "Unknown counting system (use hilo, ko or omega2)" << endl;
+        return 1;
+    }
+    if (rngKind < 0) {
+        cerr << "Unknown random number generator (use xoshiro, pcg or splitmix)" << endl;
+        return 1;
+    }
+    if (shuffleBatchSize < 1) {
+        shuffleBatchSize = 1;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    string error;
+    if (!checkRules(rules, error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    if (penetration <= 0 || penetration > 1) {
+        cerr << "Penetration must be above 0 and at most 1" << endl;
+        return 1;
+    }
+    if (seats < 0 || seats > MAX_SEATS) {
+        cerr << "Seats must be between 1 and " << MAX_SEATS << " (0 or no --seats plays without a table)" << endl;
+        return 1;
+    }
+    if (seats > 0 && (dealerMode != DEALER_EXACT || !recordFile.empty())) {
+        cerr << "Tables with --seats deal the dealer from the shoe and can't be recorded" << endl;
+        return 1;
+    }
+    if (precision < 0 || confidence <= 0 || confidence >= 1) {
+        cerr << "Precision must be positive and the confidence level between 0 and 1" << endl;
+        return 1;
+    }
+    if (!comparePolicies.empty() && (seats > 0 || dealerMode == DEALER_BATCH || !recordFile.empty())) {
+        cerr << "--compare plays one seat from one shoe per thread and can't be recorded" << endl;
+        return 1;
+    }
+    if (optimize && (seats > 0 || dealerMode == DEALER_BATCH || !recordFile.empty() || !comparePolicies.empty())) {
+        cerr << "--optimize plays one seat from one shoe per thread and can't be recorded or combined with --compare" << endl;
+        return 1;
+    }
+    if (precision > 0 && (seats > 0 || !recordFile.empty())) {
+        cerr << "Stopping at a target precision needs a single seat run without --record" << endl;
+        return 1;
+    }
+
+    // Strategy for the simulator, a file overrides the named policy
+    StrategyTable loaded;
+    const StrategyTable* strategy = selectStrategy(policyName, strategyFile, loaded, error);
+    if (strategy == nullptr) {
+        cerr << error << endl;
+        return 1;
+    }
+    if (!strategyFile.empty()) {
+        policyName = strategyFile;
+    }
+    if (printOnly) {
+        printStrategy(*strategy);
+        return 0;
+    }
+
+    if (dealerOddsOnly) {
+        return runDealerOdds(rules);
+    }
+    if (solveChart) {
+        SolverOptions options;
+        options.rules = rules;
+        return runSolveChart(options, threads);
+    }
+    if (shuffleTests > 0) {
+        return runShuffleTest(shuffleTests, rules.numDecks, rngKind, seed);
+    }
+
+    SimConfig config;
+    config.rules = rules;
+    config.penetration = penetration;
+    config.rngKind = rngKind;
+    config.shuffleBatch = shuffleBatchSize;
+    config.strategy = strategy;
+    config.takeInsurance = takeInsurance;
+    config.countSystem = countSystem;
+    config.spread = spread;
+    config.bankroll = bankroll;
+    config.dealerMode = dealerMode;
+    config.precision = precision;
+    config.confidence = confidence;
+    config.buckets = buckets;
+    if (optimize) {
+        return runOptimizer(simHands, config, threads, seed);
+    }
+    if (!comparePolicies.empty()) {
+        return runCompare(simHands, config, comparePolicies, threads, seed);
+    }
+    if (seats > 0) {
+        return runTable(simHands, config, seats, policyName, seatPolicies, seatBankrolls, threads, seed);
+    }
+    if (recordFile.empty()) {
+        return runSimulation(simHands, policyName, config, threads, seed);
+    }
+
+    // Recording: the workers append their records to the log as they play
+    HistoryFile history;
+    if (!openHistory(history, recordFile, config, simHands, threads, seed, error)) {
+        cerr << recordFile << ": " << error << endl;
+        return 1;
+    }
+    config.history = &history;
+    runSimulation(simHands, policyName, config, threads, seed);
+    if (!closeHistory(history, error)) {
+        cerr << recordFile << ": " << error << endl;
+        return 1;
+    }
+    cout << "history: " << recordFile << endl;
+    return 0;
+}
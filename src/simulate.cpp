@@ -0,0 +1,272 @@
+// Headless simulation: plays rounds with no console I/O and only keeps totals
+
+#include "blackjack.h"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+namespace blackjack {
+
+// Plays the requested number of rounds and tallies the results. Rounds are dealt from
+// one shoe until its cut card comes out, then from the next one. Once every shoe
+// has been used they are all reshuffled together with shuffleBatch.
+// With a history writer every shuffle and round is also logged, with buckets every
+// round is also added to its up card and starting hand.
+template <typename R>
+static SimResult simulateHandsWith(Shoe* shoes, Rng* rngs, int shoeCount, long long hands,
+                                   const SimConfig& config, const R& rules, HistoryWriter* history,
+                                   HandBuckets* buckets) {
+
+    SimResult result;
+    const StrategyTable& strategy = *config.strategy;
+    bool spreadBets = !config.spread.empty();
+
+    // Hands live on the stack for the whole run, no allocation per round or per split
+    PlayerHands player;
+    CardArray dealerHand;
+
+    // Shoes before the current one are past their cut card, so a later call that starts
+    // from the first shoe again carries on where this one stopped
+    int current = 0;
+    for (long long i = 0; i < hands; i++) {
+        // Switch shoes at the cut card, the round in progress has finished
+        while (shoes[current].nextCard >= shoes[current].cutCard) {
+            current++;
+            if (current == shoeCount) {
+                shuffleBatch(shoes, rngs, shoeCount);
+                current = 0;
+                if (history != nullptr) {
+                    recordShuffle(*history, shoes, shoeCount);
+                }
+            }
+        }
+        // The bet is placed before the cards come out, from the count so far
+        double bet = spreadBets ? betForCount(config.spread, trueCount(shoes[current])) : 1;
+        int firstCard = shoes[current].nextCard;
+        double round = simulateRound(shoes[current], rngs[current], player, dealerHand,
+                                     strategy, rules, config.takeInsurance, config.dealerTable);
+        double outcome = bet * round;
+        if (history != nullptr) {
+            // A shoe that ran out during the round was reshuffled and dealt on from the top
+            int cardsDealt = shoes[current].nextCard - firstCard;
+            if (cardsDealt < 0) {
+                recordReshuffle(*history, current, shoes[current]);
+                cardsDealt += shoes[current].size;
+            }
+            recordHand(*history, current, cardsDealt, player, bet, round);
+        }
+        if (buckets != nullptr) {
+            addToBuckets(*buckets, upCardValue(dealerHand), player, outcome);
+        }
+        tallyRound(result, outcome, bet);
+    }
+    return result;
+}
+
+// Plays the rounds under the configured rules. The common rule sets run a copy of the
+// round compiled for those rules, anything else reads the rules as it goes.
+SimResult simulateHands(Shoe* shoes, Rng* rngs, int shoeCount, long long hands, const SimConfig& config,
+                        HistoryWriter* history, HandBuckets* buckets) {
+
+    if (matchesRules(config.rules, FixedRules<false>())) {
+        return simulateHandsWith(shoes, rngs, shoeCount, hands, config, FixedRules<false>(), history, buckets);
+    }
+    if (matchesRules(config.rules, FixedRules<true>())) {
+        return simulateHandsWith(shoes, rngs, shoeCount, hands, config, FixedRules<true>(), history, buckets);
+    }
+    return simulateHandsWith(shoes, rngs, shoeCount, hands, config, config.rules, history, buckets);
+}
+
+// Sets up a worker's shoes, one shoe and one random stream per batch slot, all allocated and
+// shuffled before play starts. The batch dealer plays a full batch of shoes in lockstep instead.
+void startWorker(SimWorker& worker, const SimConfig& config, uint64_t seed, int stream) {
+
+    int count = (config.dealerMode == DEALER_BATCH) ? BATCH_LANES : config.shuffleBatch;
+    worker.shoes.resize(count);
+    worker.rngs.resize(count);
+    worker.stream = stream;
+    for (int k = 0; k < count; k++) {
+        seedRng(worker.rngs[k], config.rngKind, seed, (uint64_t)stream * count + k);
+        getNewDeck(worker.shoes[k], config.rules.numDecks, config.penetration);
+        setCountSystem(worker.shoes[k], config.countSystem);
+    }
+    shuffleBatch(&worker.shoes[0], &worker.rngs[0], count);
+}
+
+// Plays one block of a parallel simulation on the worker's shoes, carrying on from the last
+// block. The results are added into this worker's own slot.
+void runWorker(SimWorker& worker, long long hands, const SimConfig& config, WorkerResult* out) {
+
+    int count = (int)worker.shoes.size();
+    HandBuckets* buckets = config.buckets ? &out->buckets : nullptr;
+    SimResult part;
+    if (config.dealerMode == DEALER_BATCH) {
+        part = simulateLanes(&worker.shoes[0], &worker.rngs[0], hands, config, buckets);
+    }
+    // Recording or replaying a hand history, this worker's records go through its own writer
+    else if (config.history != nullptr || config.replay != nullptr) {
+        HistoryWriter history;
+        startHistory(history, config, worker.stream);
+        recordShuffle(history, &worker.shoes[0], count);
+        part = simulateHands(&worker.shoes[0], &worker.rngs[0], count, hands, config, &history, buckets);
+        finishHistory(history);
+    }
+    else {
+        part = simulateHands(&worker.shoes[0], &worker.rngs[0], count, hands, config, nullptr, buckets);
+    }
+    mergeResults(out->result, part);
+}
+
+// Frees a worker's shoes
+void finishWorker(SimWorker& worker) {
+
+    for (size_t k = 0; k < worker.shoes.size(); k++) {
+        freeShoe(worker.shoes[k]);
+    }
+}
+
+// Adds the tallies of one worker into the running total
+void mergeResults(SimResult& total, const SimResult& part) {
+
+    total.handsPlayed += part.handsPlayed;
+    total.wins += part.wins;
+    total.losses += part.losses;
+    total.draws += part.draws;
+    total.totalReturn += part.totalReturn;
+    total.totalWagered += part.totalWagered;
+    mergeStats(total.returns, part.returns);
+}
+
+// Splits the hand budget across threads, each with its own shoes and random streams.
+// Workers share nothing while playing, results are merged after they are joined.
+// With a target precision the hands are played in blocks, each sized from the variance so far
+// to reach the target, and the run stops after the first block where the EV interval is
+// narrow enough. The same seed and thread count always give
+// the same results.
+SimResult simulateParallel(long long hands, const SimConfig& settings, int threads, uint64_t seed,
+                           HandBuckets* buckets) {
+
+    vector<WorkerResult> slots(threads);
+    vector<SimWorker> states(threads);
+
+    // The dealer outcome table for the sampled modes is built once and only read by the workers
+    DealerTable dealerTable;
+    SimConfig config = settings;
+    if (config.dealerMode == DEALER_SHOE || config.dealerMode == DEALER_INFINITE) {
+        buildDealerTable(dealerTable, config.rules, config.dealerMode);
+        config.dealerTable = &dealerTable;
+    }
+    for (int t = 0; t < threads; t++) {
+        startWorker(states[t], config, seed, t);
+    }
+
+    SimResult total;
+    for (long long played = 0; played < hands; ) {
+        long long block = (config.precision > 0) ? precisionBlock(total.returns, config.precision, config.confidence)
+                                                 : hands;
+        long long count = (hands - played < block) ? hands - played : block;
+
+        // Give every worker an equal share, the first few take the remainder
+        vector<thread> workers;
+        long long share = count / threads;
+        long long extra = count % threads;
+        for (int t = 0; t < threads; t++) {
+            long long part = share + (t < extra ? 1 : 0);
+            if (t == threads - 1) {
+                // Last share runs on the calling thread
+                runWorker(states[t], part, config, &slots[t]);
+            }
+            else {
+                workers.push_back(thread(runWorker, ref(states[t]), part, cref(config), &slots[t]));
+            }
+        }
+        for (size_t t = 0; t < workers.size(); t++) {
+            workers[t].join();
+        }
+        played += count;
+
+        total = SimResult();
+        for (int t = 0; t < threads; t++) {
+            mergeResults(total, slots[t].result);
+        }
+        if (config.precision > 0 && confidenceHalfWidth(total.returns, config.confidence) <= config.precision) {
+            break;
+        }
+    }
+
+    for (int t = 0; t < threads; t++) {
+        finishWorker(states[t]);
+        if (buckets != nullptr) {
+            mergeBuckets(*buckets, slots[t].buckets);
+        }
+    }
+    return total;
+}
+
+// Entry point for --simulate, plays the hands and prints only the aggregate counts
+int runSimulation(long long hands, const string& policyName, const SimConfig& config, int threads, uint64_t seed) {
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    HandBuckets buckets;
+    SimResult result = simulateParallel(hands, config, threads, seed, &buckets);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double total = (double)result.handsPlayed;
+    cout << fixed << setprecision(4);
+    cout << "policy:  " << policyName << "\n";
+    cout << "seed:    " << seed << "\n";
+    cout << "rng:     " << RNG_NAMES[config.rngKind] << " (shuffle batch " << config.shuffleBatch << ")\n";
+    cout << "decks:   " << config.rules.numDecks << " (cut at " << setprecision(0) << config.penetration * 100 << "%)\n";
+    cout << "rules:   " << rulesName(config.rules) << "\n";
+    cout << "dealer:  " << DEALER_MODE_NAMES[config.dealerMode];
+    if (config.dealerMode == DEALER_BATCH) {
+        cout << " (" << BATCH_LANES << " shoes, " << BATCH_EVALUATOR_NAMES[batchEvaluator()] << " evaluator)";
+    }
+    cout << "\n";
+    cout << setprecision(4);
+    cout << "threads: " << threads << "\n";
+    cout << "hands:   " << result.handsPlayed << "\n";
+    cout << "wins:    " << result.wins << " (" << 100.0 * result.wins / total << "%)\n";
+    cout << "losses:  " << result.losses << " (" << 100.0 * result.losses / total << "%)\n";
+    cout << "draws:   " << result.draws << " (" << 100.0 * result.draws / total << "%)\n";
+    double mean = result.returns.mean;
+    double variance = sampleVariance(result.returns);
+    double halfWidth = confidenceHalfWidth(result.returns, config.confidence);
+    cout << "EV/hand: " << showpos << mean << noshowpos << "\n";
+    cout << "SD/hand: " << sqrt(variance) << "\n";
+    cout << "SE/hand: " << setprecision(5) << standardError(result.returns) << "\n";
+    cout << setprecision(0) << "CI " << config.confidence * 100 << "%:  " << setprecision(4) << showpos
+         << mean - halfWidth << " to " << mean + halfWidth << noshowpos << " (+/-" << halfWidth << ")\n";
+    if (config.precision > 0) {
+        cout << "target:  +/-" << config.precision << (halfWidth <= config.precision ? " reached after " : " not reached in ")
+             << result.handsPlayed << " hands\n";
+    }
+
+    // Counting runs also report the betting side: average bet, return on the money
+    // wagered and how likely the bankroll is to be lost
+    if (!config.spread.empty()) {
+        cout << "count:   " << COUNT_NAMES[config.countSystem] << ", spread";
+        for (size_t k = 0; k < config.spread.size(); k++) {
+            cout << (k ? "," : " ") << defaultfloat << config.spread[k];
+        }
+        cout << fixed << (countIsBalanced(config.countSystem) ? " (true count 1" : " (running count 1") << (config.spread.size() > 1 ? " to " + to_string(config.spread.size()) : string()) << "+)\n";
+        cout << "avg bet: " << result.totalWagered / total << "\n";
+        cout << "return:  " << showpos << 100.0 * result.totalReturn / result.totalWagered << noshowpos << "% of wagered\n";
+        cout << "RoR:     " << riskOfRuin(mean, variance, config.bankroll) << " (bankroll " << setprecision(0)
+             << config.bankroll << " units)\n";
+    }
+    if (config.buckets) {
+        printBuckets(buckets, config.confidence);
+    }
+    cout << fixed << setprecision(2);
+    cout << "seconds: " << seconds << "\n";
+    cout << "hands/s: " << (seconds > 0 ? total / seconds : 0.0) << endl;
+    return 0;
+}
+
+} // namespace blackjack
@@ -0,0 +1,350 @@
+// Composition dependent expected value of every player action and the strategy chart solver
+
+#include "blackjack.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+namespace blackjack {
+
+// Packs a player position into a cache key: the unseen composition, the hand's hard total,
+// whether it holds an Ace and the dealer's up card
+static DealerKey playerKey(const ShoeCounts& counts, int hardTotal, bool hasAce, int upValue) {
+
+    DealerKey key = dealerKey(counts, hardTotal, hasAce, false, false);
+    key.high |= (uint64_t)upValue << 16;
+    return key;
+}
+
+// EV of standing on playerScore (21 or less) against the up card, the dealer drawing from counts
+double standEV(EvSolver& solver, ShoeCounts& counts, int playerScore, int upValue) {
+
+    DealerOdds odds = dealerOdds(solver.dealer, counts, upValue, solver.options.peeked);
+
+    // Dealer busts or ends below the player: win, same total: push, otherwise lose
+    double ev = odds.p[DEALER_BUST] - odds.p[DEALER_BLACKJACK];
+    for (int total = DEALER_MIN; total <= BLACKJACK; total++) {
+        double p = odds.p[total - DEALER_MIN];
+        if (playerScore > total) {
+            ev += p;
+        }
+        else if (playerScore < total) {
+            ev -= p;
+        }
+    }
+    return ev;
+}
+
+// EV of the best play from here when only hitting and standing are left
+double hitStandEV(EvSolver& solver, ShoeCounts& counts, int hardTotal, bool hasAce, int upValue) {
+
+    if (hardTotal > BLACKJACK) {
+        return -1;
+    }
+    int score = (hasAce && hardTotal + 10 <= BLACKJACK) ? hardTotal + 10 : hardTotal;
+    if (score == BLACKJACK) {
+        return standEV(solver, counts, score, upValue);
+    }
+
+    DealerKey key = playerKey(counts, hardTotal, hasAce, upValue);
+    unordered_map<DealerKey, double, DealerKeyHash>::const_iterator found = solver.player.find(key);
+    if (found != solver.player.end()) {
+        solver.hits++;
+        return found->second;
+    }
+    solver.misses++;
+
+    double stand = standEV(solver, counts, score, upValue);
+    double hit = hitEV(solver, counts, hardTotal, hasAce, upValue);
+    double best = (hit > stand) ? hit : stand;
+
+    if (solver.player.size() >= solver.dealer.maxEntries) {
+        solver.player.clear();
+    }
+    solver.player[key] = best;
+    return best;
+}
+
+// EV of taking one card and then playing on with hit or stand
+double hitEV(EvSolver& solver, ShoeCounts& counts, int hardTotal, bool hasAce, int upValue) {
+
+    double ev = 0;
+    for (int v = 1; v <= 10; v++) {
+        if (counts.count[v] == 0) {
+            continue;
+        }
+        double weight = (double)counts.count[v] / counts.total;
+        removeValue(counts, v);
+        ev += weight * hitStandEV(solver, counts, hardTotal + v, hasAce || v == 1, upValue);
+        counts.count[v]++;
+        counts.total++;
+    }
+    return ev;
+}
+
+// EV of doubling: twice the bet, exactly one more card, then stand
+double doubleEV(EvSolver& solver, ShoeCounts& counts, int hardTotal, bool hasAce, int upValue) {
+
+    double ev = 0;
+    for (int v = 1; v <= 10; v++) {
+        if (counts.count[v] == 0) {
+            continue;
+        }
+        double weight = (double)counts.count[v] / counts.total;
+        int hard = hardTotal + v;
+        bool ace = hasAce || v == 1;
+        int score = (ace && hard + 10 <= BLACKJACK) ? hard + 10 : hard;
+        removeValue(counts, v);
+        ev += weight * ((score > BLACKJACK) ? -1 : standEV(solver, counts, score, upValue));
+        counts.count[v]++;
+        counts.total++;
+    }
+    return 2 * ev;
+}
+
+// EV of splitting a pair of the given value, both cards already removed from counts.
+// Each hand is played as if the other drew from the same composition (no resplits).
+// Split Aces get one card each; other hands may hit, stand and double if allowed.
+double splitEV(EvSolver& solver, ShoeCounts& counts, int value, int upValue) {
+
+    double ev = 0;
+    for (int v = 1; v <= 10; v++) {
+        if (counts.count[v] == 0) {
+            continue;
+        }
+        double weight = (double)counts.count[v] / counts.total;
+        int hard = value + v;
+        bool ace = (value == 1) || v == 1;
+        int score = (ace && hard + 10 <= BLACKJACK) ? hard + 10 : hard;
+        removeValue(counts, v);
+
+        double hand = 0;
+        if (value == 1) {
+            hand = standEV(solver, counts, score, upValue);
+        }
+        else {
+            hand = hitStandEV(solver, counts, hard, ace, upValue);
+            if (solver.options.rules.doubleAfterSplit) {
+                double dbl = doubleEV(solver, counts, hard, ace, upValue);
+                if (dbl > hand) {
+                    hand = dbl;
+                }
+            }
+        }
+        ev += weight * hand;
+        counts.count[v]++;
+        counts.total++;
+    }
+    return 2 * ev;
+}
+
+// EV of every action for a hand against the up card. unseen holds every card the player
+// hasn't seen: it must already exclude the player's cards and the up card. The caller says
+// which of split, double and surrender the hand may take under the rules and the round so far,
+// only those are allowed and the best action is picked among the allowed ones.
+ActionEV solveHand(EvSolver& solver, const ShoeCounts& unseen, const CardArray& hand, int upValue,
+                   bool canSplit, bool canDouble, bool canSurrender) {
+
+    ActionEV result;
+    ShoeCounts counts = unseen;
+
+    int soft = 0, hard = 0, aces = 0;
+    computeTotals(hand, soft, hard, aces);
+    int score = (soft <= BLACKJACK) ? soft : hard;
+
+    result.allowed[STAND] = true;
+    result.ev[STAND] = (score > BLACKJACK) ? -1 : standEV(solver, counts, score, upValue);
+    result.allowed[HIT] = (score < BLACKJACK);
+    if (result.allowed[HIT]) {
+        result.ev[HIT] = hitEV(solver, counts, hard, aces > 0, upValue);
+    }
+    result.allowed[DOUBLE] = canDouble && score < BLACKJACK;
+    if (result.allowed[DOUBLE]) {
+        result.ev[DOUBLE] = doubleEV(solver, counts, hard, aces > 0, upValue);
+    }
+    int first = HARD_VALUE[cardRank(hand.cards[0])];
+    result.allowed[SPLIT] = canSplit;
+    if (result.allowed[SPLIT]) {
+        result.ev[SPLIT] = splitEV(solver, counts, first, upValue);
+    }
+    result.allowed[SURRENDER] = canSurrender;
+    if (result.allowed[SURRENDER]) {
+        result.ev[SURRENDER] = -0.5;
+    }
+
+    for (int a = 0; a < ACTION_COUNT; a++) {
+        if (result.allowed[a] && result.ev[a] > result.ev[result.best]) {
+            result.best = a;
+        }
+    }
+    return result;
+}
+
+// Chart code for an EV result: the best action, with the fallback folded in for
+// doubles and surrenders (Ds / Rs when standing beats hitting)
+static string chartCode(const ActionEV& result) {
+
+    bool standOverHit = result.ev[STAND] >= result.ev[HIT] || !result.allowed[HIT];
+    if (result.best == DOUBLE) {
+        return standOverHit ? ACTION_CODES[DOUBLE_STAND] : ACTION_CODES[DOUBLE];
+    }
+    if (result.best == SURRENDER) {
+        return standOverHit ? ACTION_CODES[SURRENDER_STAND] : ACTION_CODES[SURRENDER];
+    }
+    return ACTION_CODES[result.best];
+}
+
+// Averages the EVs of several two card hands that share a chart row, weighted by how
+// likely each one is to be dealt
+static void addWeighted(ActionEV& total, const ActionEV& part, double weight) {
+
+    for (int a = 0; a < ACTION_COUNT; a++) {
+        total.ev[a] += weight * part.ev[a];
+        total.allowed[a] = part.allowed[a];
+    }
+}
+
+// Solves every chart row against one up card, writing codes into rows[row][column]
+static void solveUpCard(const SolverOptions& options, int up, int column, vector<vector<string> >* rows) {
+
+    EvSolver solver;
+    solver.options = options;
+    solver.dealer.hitSoft17 = options.rules.hitSoft17;
+
+    ShoeCounts shoe = fullShoeCounts(options.rules.numDecks);
+    removeValue(shoe, up);
+
+    CardArray hand;
+
+    // EV of every two card hand (a <= b) and the chance of being dealt it
+    ActionEV evs[11][11];
+    double weights[11][11];
+    for (int a = 1; a <= 10; a++) {
+        for (int b = a; b <= 10; b++) {
+            weights[a][b] = 0;
+            if (shoe.count[a] == 0 || shoe.count[b] - (a == b) <= 0) {
+                continue;
+            }
+            weights[a][b] = (a == b) ? (double)shoe.count[a] * (shoe.count[a] - 1)
+                                     : 2.0 * shoe.count[a] * shoe.count[b];
+            ShoeCounts counts = shoe;
+            removeValue(counts, a);
+            removeValue(counts, b);
+            clearHand(hand);
+            addCard(hand, makeCard(a, 0));
+            addCard(hand, makeCard(b, 0));
+            // A fresh two card hand: any pair splits, everything doubles, surrender per the rules
+            const Rules& rules = solver.options.rules;
+            evs[a][b] = solveHand(solver, counts, hand, up, a == b && rules.maxHands > 1, true, rules.surrender);
+        }
+    }
+
+    // Hard and soft rows average the hands without a pair, unless the total only comes as a pair
+    for (int row = 4; row < PAIR_ROWS; row++) {
+        bool softRow = row >= SOFT_ROWS;
+        int total = softRow ? row - SOFT_ROWS : row;
+        if (total > BLACKJACK || (softRow && total < 12)) {
+            continue;
+        }
+        for (int pass = 0; pass < 2; pass++) {
+            ActionEV sum;
+            double weight = 0;
+            for (int a = 1; a <= 10; a++) {
+                for (int b = a; b <= 10; b++) {
+                    bool isPair = (a == b);
+                    bool hasAce = (a == 1);
+                    int hard = a + b;
+                    int t = (hasAce && hard + 10 <= BLACKJACK) ? hard + 10 : hard;
+                    if (weights[a][b] == 0 || isPair != (pass == 1) || hasAce != softRow || t != total) {
+                        continue;
+                    }
+                    addWeighted(sum, evs[a][b], weights[a][b]);
+                    weight += weights[a][b];
+                }
+            }
+            if (weight > 0) {
+                sum.allowed[SPLIT] = false;
+                sum.best = STAND;
+                for (int a = 0; a < ACTION_COUNT; a++) {
+                    sum.ev[a] /= weight;
+                    if (sum.allowed[a] && sum.ev[a] > sum.ev[sum.best]) {
+                        sum.best = a;
+                    }
+                }
+                // A two card 21 is a natural and never played
+                (*rows)[row][column] = (total == BLACKJACK) ? ACTION_CODES[STAND] : chartCode(sum);
+                break;
+            }
+        }
+    }
+
+    // Pair rows take split into account
+    for (int value = 1; value <= 10; value++) {
+        if (weights[value][value] > 0) {
+            (*rows)[PAIR_ROWS + value][column] = chartCode(evs[value][value]);
+        }
+    }
+}
+
+// Entry point for --solve-chart. Works out the composition dependent EV of every action
+// for every two card hand and up card from a full shoe and prints the best actions as a
+// strategy chart that --strategy can load. Up cards are solved in parallel, one solver each.
+int runSolveChart(const SolverOptions& options, int threads) {
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    // Rows default to standing, the solver fills in every row a two card hand can reach
+    vector<vector<string> > rows(STRATEGY_ROWS, vector<string>(10, ACTION_CODES[STAND]));
+
+    // Hand up cards out round robin, each thread writes only its own columns
+    int workers = (threads < 10) ? threads : 10;
+    vector<thread> pool;
+    for (int t = 0; t < workers; t++) {
+        pool.push_back(thread([t, workers, &options, &rows]() {
+            for (int column = t; column < 10; column += workers) {
+                int up = (column == 9) ? 1 : column + 2;
+                solveUpCard(options, up, column, &rows);
+            }
+        }));
+    }
+    for (size_t t = 0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    const Rules& rules = options.rules;
+    cout << "# Composition dependent strategy for " << rules.numDecks << " deck" << (rules.numDecks > 1 ? "s" : "")
+         << (rules.hitSoft17 ? ", dealer hits soft 17" : ", dealer stands on soft 17")
+         << (options.peeked ? ", peek" : ", no peek")
+         << (rules.doubleAfterSplit ? ", DAS" : "") << (rules.surrender ? ", late surrender" : "") << "\n";
+    cout << "# solved in " << fixed << setprecision(2) << seconds << " s with " << workers << " thread"
+         << (workers > 1 ? "s" : "") << "\n";
+    cout << "#        2  3  4  5  6  7  8  9  10 A" << "\n";
+    for (int row = 4; row < STRATEGY_ROWS; row++) {
+        if ((row > BLACKJACK && row < SOFT_ROWS + 12) || row == PAIR_ROWS) {
+            continue;
+        }
+        if (row <= BLACKJACK) {
+            cout << "hard " << left << setw(3) << row;
+        }
+        else if (row < PAIR_ROWS) {
+            cout << "soft " << left << setw(3) << row - SOFT_ROWS;
+        }
+        else {
+            int value = row - PAIR_ROWS;
+            cout << "pair " << left << setw(3) << (value == 1 ? string("A") : to_string(value));
+        }
+        for (int column = 0; column < 10; column++) {
+            cout << " " << left << setw(2) << rows[row][column];
+        }
+        cout << "\n";
+    }
+    cout << right << flush;
+    return 0;
+}
+
+} // namespace blackjack
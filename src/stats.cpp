@@ -0,0 +1,176 @@
+// Streaming statistics: running means and variances that merge across threads, confidence
+// intervals, and the breakdown of the results by dealer up card and starting hand
+
+#include "blackjack.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+namespace blackjack {
+
+// Adds another stream's results, as if they had been added one by one (Chan's formula)
+void mergeStats(RunningStats& total, const RunningStats& part) {
+
+    if (part.count == 0) {
+        return;
+    }
+    if (total.count == 0) {
+        total = part;
+        return;
+    }
+    long long count = total.count + part.count;
+    double delta = part.mean - total.mean;
+    total.mean += delta * part.count / count;
+    total.m2 += part.m2 + delta * delta * ((double)total.count * part.count / count);
+    total.count = count;
+}
+
+// Variance of the results, 0 until there are two of them
+double sampleVariance(const RunningStats& stats) {
+
+    return (stats.count > 1) ? stats.m2 / (stats.count - 1) : 0;
+}
+
+// Standard error of the mean
+double standardError(const RunningStats& stats) {
+
+    return (stats.count > 1) ? sqrt(sampleVariance(stats) / stats.count) : 0;
+}
+
+// Point of the standard normal distribution with probability p below it, for 0 < p < 1.
+// Rational approximation by Acklam, good to about 1e-9, plenty for a confidence level.
+double normalQuantile(double p) {
+
+    static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+    static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                6.680131188771972e+01, -1.328068155288572e+01 };
+    static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+    static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                3.754408661907416e+00 };
+    const double low = 0.02425;
+
+    // The tails use a different fit than the middle, the upper tail mirrors the lower one
+    if (p < low || p > 1 - low) {
+        double q = sqrt(-2 * log(p < low ? p : 1 - p));
+        double x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+                   ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+        return (p < low) ? x : -x;
+    }
+    double q = p - 0.5;
+    double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+// Half the width of the two sided confidence interval of the mean. Millions of hands make
+// the normal approximation safe. Infinite until there are two results.
+double confidenceHalfWidth(const RunningStats& stats, double confidence) {
+
+    if (stats.count < 2) {
+        return HUGE_VAL;
+    }
+    return normalQuantile(0.5 + confidence / 2) * standardError(stats);
+}
+
+// Hands still to play before the interval is expected to be within +/-precision, from the
+// variance so far: (z * sd / precision)^2 in all, less those played. At least
+// PRECISION_MIN_HANDS, so a noisy early estimate can't stall the run in tiny blocks.
+long long precisionBlock(const RunningStats& stats, double precision, double confidence) {
+
+    if (stats.count < 2) {
+        return PRECISION_MIN_HANDS;
+    }
+    double width = normalQuantile(0.5 + confidence / 2) * sqrt(sampleVariance(stats)) / precision;
+    double needed = ceil(width * width) - stats.count;
+    return (needed > PRECISION_MIN_HANDS) ? (long long)needed : PRECISION_MIN_HANDS;
+}
+
+// Bucket of the player's first two cards. After a split the first hand still holds one of
+// the pair, so the starting hand was two of that card.
+int startBucket(const PlayerHands& player) {
+
+    const CardArray& first = player.hands[0];
+    int a = HARD_VALUE[cardRank(first.cards[0])];
+    int b = (player.count > 1) ? a : HARD_VALUE[cardRank(first.cards[1])];
+    int hard = a + b;
+    int hardBuckets = HARD_START_MAX - HARD_START_MIN + 1;
+    if (a == 1 || b == 1) {
+        // An Ace and a ten card is a blackjack, the last bucket
+        if (hard + 10 == BLACKJACK) {
+            return START_BUCKETS - 1;
+        }
+        return hardBuckets + hard + 10 - SOFT_START_MIN;
+    }
+    return hard - HARD_START_MIN;
+}
+
+// Name of a starting hand bucket, like "hard 16" or "soft 18"
+string startBucketName(int bucket) {
+
+    int hardBuckets = HARD_START_MAX - HARD_START_MIN + 1;
+    if (bucket == START_BUCKETS - 1) {
+        return "blackjack";
+    }
+    if (bucket >= hardBuckets) {
+        return "soft " + to_string(bucket - hardBuckets + SOFT_START_MIN);
+    }
+    return "hard " + to_string(bucket + HARD_START_MIN);
+}
+
+// Adds a round's result to its up card and starting hand
+void addToBuckets(HandBuckets& buckets, int upValue, const PlayerHands& player, double outcome) {
+
+    addSample(buckets.byUpcard[upValue - 1], outcome);
+    addSample(buckets.byStart[startBucket(player)], outcome);
+}
+
+// Adds another worker's buckets
+void mergeBuckets(HandBuckets& total, const HandBuckets& part) {
+
+    for (int u = 0; u < UPCARD_BUCKETS; u++) {
+        mergeStats(total.byUpcard[u], part.byUpcard[u]);
+    }
+    for (int s = 0; s < START_BUCKETS; s++) {
+        mergeStats(total.byStart[s], part.byStart[s]);
+    }
+}
+
+// Prints one line of a bucket table: share of the hands, EV and its confidence interval
+static void printBucket(const string& name, const RunningStats& stats, long long hands, double confidence) {
+
+    cout << left << setw(11) << name << right << setw(13) << stats.count
+         << setprecision(2) << setw(8) << (hands > 0 ? 100.0 * stats.count / hands : 0.0) << "%"
+         << setprecision(4) << showpos << setw(10) << stats.mean << noshowpos;
+    if (stats.count > 1) {
+        cout << setw(10) << confidenceHalfWidth(stats, confidence) << setw(9) << sqrt(sampleVariance(stats));
+    }
+    cout << "\n";
+}
+
+// Prints the EV by dealer up card and by starting hand, each with its confidence interval
+void printBuckets(const HandBuckets& buckets, double confidence) {
+
+    long long hands = 0;
+    for (int u = 0; u < UPCARD_BUCKETS; u++) {
+        hands += buckets.byUpcard[u].count;
+    }
+    cout << fixed << setprecision(0);
+    string interval = "+/-" + to_string((int)lround(confidence * 100)) + "%";
+    cout << left << setw(11) << "up card" << right << setw(13) << "hands" << setw(9) << "share"
+         << setw(10) << "EV/hand" << setw(10) << interval << setw(9) << "SD/hand" << "\n";
+    for (int u = 0; u < UPCARD_BUCKETS; u++) {
+        printBucket(u == 0 ? "A" : to_string(u + 1), buckets.byUpcard[u], hands, confidence);
+    }
+    cout << left << setw(11) << "start" << right << setw(13) << "hands" << setw(9) << "share"
+         << setw(10) << "EV/hand" << setw(10) << interval << setw(9) << "SD/hand" << "\n";
+    for (int s = 0; s < START_BUCKETS; s++) {
+        printBucket(startBucketName(s), buckets.byStart[s], hands, confidence);
+    }
+}
+
+} // namespace blackjack
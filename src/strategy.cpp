@@ -0,0 +1,226 @@
+// Table driven strategy: row lookup, decisions, and reading and printing strategy charts
+
+#include "blackjack.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+namespace blackjack {
+
+// Row of the strategy table for a hand: the pair row for two cards of the same value
+// (only when splitting is possible), otherwise the soft or hard total row
+int handRow(const CardArray& hand, bool canSplit) {
+
+    if (canSplit && hand.usedCards == 2 &&
+        HARD_VALUE[cardRank(hand.cards[0])] == HARD_VALUE[cardRank(hand.cards[1])]) {
+        return PAIR_ROWS + HARD_VALUE[cardRank(hand.cards[0])];
+    }
+
+    return totalsRow(hand.score, hand.hardTotal);
+}
+
+// Row of the strategy table for totals that are already known (pairs aside)
+int totalsRow(int softTotal, int hardTotal) {
+
+    if (softTotal != hardTotal) {
+        return SOFT_ROWS + softTotal;
+    }
+    // Busted hands are never looked up, keep the index inside the table anyway
+    return (hardTotal <= BLACKJACK) ? hardTotal : BLACKJACK;
+}
+
+// Column of the strategy table for the dealer's up card, 1 for an Ace and 10 for tens and faces
+int upCardValue(const CardArray& dealerHand) {
+
+    return HARD_VALUE[cardRank(dealerHand.cards[0])];
+}
+
+// Turns a table action into one that can be played right now: doubles and surrenders fall
+// back to hit or stand, a split that isn't allowed uses the hand's total instead
+int resolveAction(const StrategyTable& table, int action, const CardArray& hand, int upValue,
+                  bool canDouble, bool canSurrender) {
+
+    if (action == SPLIT) {
+        action = table.action[handRow(hand, false)][upValue];
+    }
+    if (action == DOUBLE) {
+        return canDouble ? DOUBLE : HIT;
+    }
+    if (action == DOUBLE_STAND) {
+        return canDouble ? DOUBLE : STAND;
+    }
+    if (action == SURRENDER) {
+        return canSurrender ? SURRENDER : HIT;
+    }
+    if (action == SURRENDER_STAND) {
+        return canSurrender ? SURRENDER : STAND;
+    }
+    return action;
+}
+
+// Decision for a hand against the dealer's up card value, a table load plus the fallbacks
+// for actions that aren't available on this hand
+int strategyDecision(const StrategyTable& table, const CardArray& hand, int upValue,
+                     bool canSplit, bool canDouble, bool canSurrender) {
+
+    int action = table.action[handRow(hand, canSplit)][upValue];
+    if (action <= HIT || (action == SPLIT && canSplit)) {
+        return action;
+    }
+    return resolveAction(table, action, hand, upValue, canDouble, canSurrender);
+}
+
+// Looks up a built in strategy by the name given on the command line, nullptr if unknown
+const StrategyTable* strategyByName(const string& name) {
+
+    if (name == "bicycle") {
+        return &BICYCLE_STRATEGY;
+    }
+    if (name == "dealer") {
+        return &MIMIC_DEALER_STRATEGY;
+    }
+    if (name == "neverbust") {
+        return &NEVER_BUST_STRATEGY;
+    }
+    return nullptr;
+}
+
+// Loads a strategy table from a text file. Each line is "hard N", "soft N" or "pair V"
+// followed by ten action codes (S H D Ds P R Rs) for dealer up cards 2-10 and A.
+// # starts a comment. Rows that aren't in the file keep the Bicycle decision, pair rows
+// that aren't in the file play like the hand's total.
+// Returns false and sets error (with the line number) if the file can't be used.
+bool loadStrategy(const string& path, StrategyTable& table, string& error) {
+
+    ifstream file(path);
+    if (!file) {
+        error = "cannot open strategy file";
+        return false;
+    }
+
+    table = BICYCLE_STRATEGY;
+    bool pairGiven[STRATEGY_COLUMNS] = { false };
+    string line;
+    int lineNumber = 0;
+
+    while (getline(file, line)) {
+        lineNumber++;
+        // Strip comments and skip blank lines
+        size_t hash = line.find('#');
+        if (hash != string::npos) {
+            line = line.substr(0, hash);
+        }
+        istringstream fields(line);
+        string kind, label;
+        if (!(fields >> kind)) {
+            continue;
+        }
+        fields >> label;
+
+        // Work out which row the line fills in
+        int row = -1;
+        int number = (label == "A") ? 1 : atoi(label.c_str());
+        if (kind == "hard" && number >= 4 && number <= BLACKJACK) {
+            row = number;
+        }
+        else if (kind == "soft" && number >= 12 && number <= BLACKJACK) {
+            row = SOFT_ROWS + number;
+        }
+        else if (kind == "pair" && number >= 1 && number <= 10) {
+            row = PAIR_ROWS + number;
+            pairGiven[number] = true;
+        }
+        if (row < 0) {
+            error = "line " + to_string(lineNumber) + ": expected hard 4-21, soft 12-21 or pair 2-10/A";
+            return false;
+        }
+
+        // Ten actions, dealer 2 through 10 then the Ace
+        for (int column = 0; column < 10; column++) {
+            string code;
+            if (!(fields >> code)) {
+                error = "line " + to_string(lineNumber) + ": expected 10 actions";
+                return false;
+            }
+            int action = -1;
+            for (int a = 0; a < ACTION_COUNT; a++) {
+                if (code == ACTION_CODES[a]) {
+                    action = a;
+                }
+            }
+            if (action < 0 || (action == SPLIT && kind != "pair")) {
+                error = "line " + to_string(lineNumber) + ": bad action '" + code + "'";
+                return false;
+            }
+            int up = (column == 9) ? 1 : column + 2;
+            table.action[row][up] = (unsigned char)action;
+        }
+    }
+
+    // Pairs that weren't given play like their total
+    for (int value = 1; value <= 10; value++) {
+        if (!pairGiven[value]) {
+            int row = (value == 1) ? SOFT_ROWS + 12 : value * 2;
+            for (int up = 1; up < STRATEGY_COLUMNS; up++) {
+                table.action[PAIR_ROWS + value][up] = table.action[row][up];
+            }
+        }
+    }
+    return true;
+}
+
+// Prints a strategy table in the same format loadStrategy reads
+void printStrategy(const StrategyTable& table) {
+
+    cout << "#        2  3  4  5  6  7  8  9  10 A" << "\n";
+    for (int row = 4; row < STRATEGY_ROWS; row++) {
+        // Soft totals start at 12, pairs at value 1 (Aces)
+        if (row > BLACKJACK && row < SOFT_ROWS + 12) {
+            continue;
+        }
+        if (row == PAIR_ROWS) {
+            continue;
+        }
+        if (row <= BLACKJACK) {
+            cout << "hard " << left << setw(3) << row;
+        }
+        else if (row < PAIR_ROWS) {
+            cout << "soft " << left << setw(3) << row - SOFT_ROWS;
+        }
+        else {
+            int value = row - PAIR_ROWS;
+            cout << "pair " << left << setw(3) << (value == 1 ? string("A") : to_string(value));
+        }
+        for (int column = 0; column < 10; column++) {
+            int up = (column == 9) ? 1 : column + 2;
+            cout << " " << left << setw(2) << ACTION_CODES[table.action[row][up]];
+        }
+        cout << "\n";
+    }
+    cout << right << flush;
+}
+
+// Strategy for the advisor and the simulator: a strategy file if one is given, else the named
+// policy. Returns nullptr and sets error if the file can't be read or the name is unknown.
+const StrategyTable* selectStrategy(const string& policyName, const string& strategyFile,
+                                    StrategyTable& loaded, string& error) {
+
+    if (!strategyFile.empty()) {
+        if (!loadStrategy(strategyFile, loaded, error)) {
+            error = strategyFile + ": " + error;
+            return nullptr;
+        }
+        return &loaded;
+    }
+    const StrategyTable* strategy = strategyByName(policyName);
+    if (strategy == nullptr) {
+        error = "Unknown policy: " + policyName + " (use bicycle, dealer or neverbust)";
+    }
+    return strategy;
+}
+
+} // namespace blackjack
@@ -0,0 +1,300 @@
+// Multi-seat tables: several seats share one shoe and one dealer hand
+
+#include "blackjack.h"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+namespace blackjack {
+
+// Notes a finished hand for settling
+static inline void addFinished(TableHands& finished, int seat, unsigned char kind, int score, double bet) {
+
+    int i = finished.count++;
+    finished.seat[i] = (unsigned char)seat;
+    finished.kind[i] = kind;
+    finished.score[i] = (unsigned char)score;
+    finished.bet[i] = bet;
+}
+
+// Settles every finished hand of the round against the dealer's hand in one pass and adds
+// the results to the seats' roundNet. A dealer blackjack beats every hand but a natural.
+void settleTable(TableSeats& seats, const CardArray& dealerHand, double blackjackPays) {
+
+    PROFILE_SCOPE(PHASE_EVALUATE);
+    const TableHands& finished = seats.finished;
+    int dealerScore = dealerHand.score;
+    bool dealerBlackjack = dealerHand.blackjack;
+    bool dealerBust = dealerHand.bust;
+
+    for (int i = 0; i < finished.count; i++) {
+        int score = finished.score[i];
+        double won;
+        if (finished.kind[i] == HAND_NATURAL) {
+            won = dealerBlackjack ? 0 : blackjackPays;
+        }
+        else if (finished.kind[i] == HAND_SURRENDERED) {
+            won = -SURRENDER_LOSS;
+        }
+        else if (dealerBlackjack || score > BLACKJACK) {
+            won = -1;
+        }
+        else {
+            won = dealerBust ? 1 : (score > dealerScore) - (score < dealerScore);
+        }
+        seats.roundNet[finished.seat[i]] += won * finished.bet[i];
+    }
+}
+
+// Plays one round at the table. Seats with a bet get their first card from the dealer's left,
+// then the dealer's up card, the second cards and the hole card, so every seat sees the card
+// removal of the seats before it. Seats then play in order from the same shoe and the dealer
+// draws once for all of them.
+template <typename R>
+static void playTableRound(Shoe& shoe, Rng& rng, TableSeats& seats, CardArray& dealerHand,
+                           const R& rules, bool takeInsurance) {
+
+    PROFILE_SCOPE(PHASE_ROUND);
+    clearHand(dealerHand);
+    seats.finished.count = 0;
+    for (int s = 0; s < seats.count; s++) {
+        seats.roundNet[s] = 0;
+        if (seats.bet[s] > 0) {
+            resetHands(seats.hands[s]);
+        }
+    }
+
+    for (int card = 0; card < 2; card++) {
+        for (int s = 0; s < seats.count; s++) {
+            if (seats.bet[s] > 0) {
+                drawCard(shoe, seats.hands[s].hands[0], rng);
+            }
+        }
+        drawCard(shoe, dealerHand, rng);
+    }
+    int upValue = upCardValue(dealerHand);
+
+    // Insurance is settled when the dealer peeks
+    if (takeInsurance && upValue == 1) {
+        double insurance = dealerHand.blackjack ? 2 * INSURANCE_BET : -INSURANCE_BET;
+        for (int s = 0; s < seats.count; s++) {
+            seats.roundNet[s] += insurance * seats.bet[s];
+        }
+    }
+
+    bool dealerPlays = false;
+    for (int s = 0; s < seats.count; s++) {
+        if (seats.bet[s] <= 0) {
+            continue;
+        }
+        PlayerHands& player = seats.hands[s];
+        const CardArray& first = player.hands[0];
+
+        // Naturals are paid at once and nobody acts against a dealer blackjack
+        if (first.blackjack) {
+            addFinished(seats.finished, s, HAND_NATURAL, BLACKJACK, seats.bet[s]);
+            continue;
+        }
+        if (dealerHand.blackjack) {
+            addFinished(seats.finished, s, HAND_PLAYED, first.score, seats.bet[s]);
+            continue;
+        }
+
+        if (playHands(shoe, rng, player, upValue, *seats.strategy[s], rules)) {
+            dealerPlays = true;
+        }
+        if (player.surrendered) {
+            addFinished(seats.finished, s, HAND_SURRENDERED, first.score, seats.bet[s]);
+            continue;
+        }
+        for (int h = 0; h < player.count; h++) {
+            addFinished(seats.finished, s, HAND_PLAYED, player.hands[h].score, seats.bet[s] * player.bets[h]);
+        }
+    }
+
+    // The dealer only draws if some hand is still standing
+    if (dealerPlays) {
+        PROFILE_SCOPE(PHASE_DEALER);
+        while (dealerHits(dealerHand, rules)) {
+            drawCard(shoe, dealerHand, rng);
+        }
+    }
+    settleTable(seats, dealerHand, rules.blackjackPays);
+}
+
+// Most a round can lose per unit bet: every hand of a full split doubled and lost, plus the
+// insurance. A seat only bets when its bankroll covers that, so it can never go below zero.
+static double worstRoundLoss(const SimConfig& sim) {
+
+    return 2.0 * sim.rules.maxHands + (sim.takeInsurance ? INSURANCE_BET : 0);
+}
+
+// Plays rounds at a table from one shoe, reshuffled at the cut card. Every seat bets what
+// the spread asks for at the current count and sits out the rounds whose worst case loss its
+// bankroll can't cover.
+template <typename R>
+static TableResult simulateTableWith(Shoe& shoe, Rng& rng, long long rounds, const TableConfig& config, const R& rules) {
+
+    TableResult result;
+    const SimConfig& sim = config.sim;
+    bool spreadBets = !sim.spread.empty();
+
+    // Seats and hands live on the stack for the whole run
+    TableSeats seats;
+    CardArray dealerHand;
+    double worst = worstRoundLoss(sim);
+    seats.count = config.seats;
+    for (int s = 0; s < seats.count; s++) {
+        seats.strategy[s] = config.strategy[s];
+        seats.bankroll[s] = (config.bankroll[s] > 0) ? config.bankroll[s] : HUGE_VAL;
+    }
+
+    for (long long i = 0; i < rounds; i++) {
+        reshuffleAtCutCard(shoe, rng);
+
+        // Bets are placed before the cards come out, from the count so far
+        double bet = spreadBets ? betForCount(sim.spread, trueCount(shoe)) : 1;
+        int playing = 0;
+        for (int s = 0; s < seats.count; s++) {
+            seats.bet[s] = (seats.bankroll[s] >= bet * worst) ? bet : 0;
+            playing += (seats.bet[s] > 0);
+        }
+        // Without a seat in play no card comes out and the count can't change, the run is over
+        if (playing == 0) {
+            break;
+        }
+
+        playTableRound(shoe, rng, seats, dealerHand, rules, sim.takeInsurance);
+        result.rounds++;
+
+        for (int s = 0; s < seats.count; s++) {
+            if (seats.bet[s] <= 0) {
+                continue;
+            }
+            double net = seats.roundNet[s];
+            seats.bankroll[s] += net;
+            tallyRound(result.seats[s], net, seats.bet[s]);
+        }
+    }
+
+    // A seat is broke once it can't cover a round at even the smallest bet
+    double smallest = 1;
+    for (size_t k = 0; k < sim.spread.size(); k++) {
+        smallest = (k == 0 || sim.spread[k] < smallest) ? sim.spread[k] : smallest;
+    }
+    for (int s = 0; s < seats.count; s++) {
+        if (config.bankroll[s] > 0) {
+            result.bankroll[s] = seats.bankroll[s];
+            result.broke[s] = (seats.bankroll[s] < smallest * worst) ? 1 : 0;
+        }
+    }
+    return result;
+}
+
+// Plays the rounds under the configured rules, the common rule sets run a copy compiled for them
+TableResult simulateTable(Shoe& shoe, Rng& rng, long long rounds, const TableConfig& config) {
+
+    const Rules& rules = config.sim.rules;
+    if (matchesRules(rules, FixedRules<false>())) {
+        return simulateTableWith(shoe, rng, rounds, config, FixedRules<false>());
+    }
+    if (matchesRules(rules, FixedRules<true>())) {
+        return simulateTableWith(shoe, rng, rounds, config, FixedRules<true>());
+    }
+    return simulateTableWith(shoe, rng, rounds, config, rules);
+}
+
+// Runs one share of a table simulation on its own shoe and random stream
+void tableWorker(long long rounds, const TableConfig& config, uint64_t seed, int stream, TableWorkerResult* out) {
+
+    Shoe shoe;
+    Rng rng;
+    seedRng(rng, config.sim.rngKind, seed, (uint64_t)stream);
+    getNewDeck(shoe, config.sim.rules.numDecks, config.sim.penetration);
+    setCountSystem(shoe, config.sim.countSystem);
+    shuffleDeck(shoe, rng);
+    out->result = simulateTable(shoe, rng, rounds, config);
+    freeShoe(shoe);
+}
+
+// Entry point for --simulate with --seats, plays the rounds on every thread and prints one
+// line per seat. A seat's bankroll is one session at the table, so a table with bankrolls
+// plays all its rounds from one shoe on one thread.
+int runTableSimulation(long long rounds, const TableConfig& config, int threads, uint64_t seed) {
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    bool bankrolled = false;
+    for (int s = 0; s < config.seats; s++) {
+        bankrolled = bankrolled || config.bankroll[s] > 0;
+    }
+    if (bankrolled) {
+        threads = 1;
+    }
+    vector<TableWorkerResult> slots(threads);
+    vector<thread> workers;
+    long long share = rounds / threads;
+    long long extra = rounds % threads;
+    for (int t = 0; t < threads; t++) {
+        long long count = share + (t < extra ? 1 : 0);
+        if (t == threads - 1) {
+            tableWorker(count, config, seed, t, &slots[t]);
+        }
+        else {
+            workers.push_back(thread(tableWorker, count, cref(config), seed, t, &slots[t]));
+        }
+    }
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+
+    TableResult total;
+    for (int t = 0; t < threads; t++) {
+        total.rounds += slots[t].result.rounds;
+        for (int s = 0; s < config.seats; s++) {
+            mergeResults(total.seats[s], slots[t].result.seats[s]);
+            total.bankroll[s] += slots[t].result.bankroll[s];
+            total.broke[s] += slots[t].result.broke[s];
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    const SimConfig& sim = config.sim;
+    cout << fixed << setprecision(4);
+    cout << "seats:   " << config.seats << "\n";
+    cout << "seed:    " << seed << "\n";
+    cout << "rng:     " << RNG_NAMES[sim.rngKind] << "\n";
+    cout << "decks:   " << sim.rules.numDecks << " (cut at " << setprecision(0) << sim.penetration * 100 << "%)\n";
+    cout << "rules:   " << rulesName(sim.rules) << "\n";
+    cout << "threads: " << threads << (bankrolled ? " (bankrolls play one session)" : "") << "\n";
+    cout << "rounds:  " << total.rounds << "\n";
+    cout << left << setw(6) << "seat" << setw(28) << "policy" << right << setw(12) << "hands"
+         << setw(10) << "EV/hand" << setw(9) << "SD/hand" << setw(10) << "avg bet" << setw(12) << "bankroll"
+         << setw(8) << "broke" << "\n";
+    for (int s = 0; s < config.seats; s++) {
+        const SimResult& seat = total.seats[s];
+        double hands = (double)seat.handsPlayed;
+        double mean = seat.returns.mean;
+        double variance = sampleVariance(seat.returns);
+        cout << left << setw(6) << s + 1 << setw(28) << config.names[s] << right << setw(12) << seat.handsPlayed
+             << setprecision(4) << setw(10) << showpos << mean << noshowpos << setw(9) << sqrt(variance)
+             << setprecision(2) << setw(10) << (hands > 0 ? seat.totalWagered / hands : 0.0);
+        if (config.bankroll[s] > 0) {
+            // Bankroll left at the end of the session, and whether the seat went broke
+            cout << setw(12) << total.bankroll[s] << setw(8) << (total.broke[s] ? "yes" : "no");
+        }
+        else {
+            cout << setw(12) << "-" << setw(8) << "-";
+        }
+        cout << "\n";
+    }
+    cout << "seconds: " << seconds << "\n";
+    cout << "rounds/s: " << (seconds > 0 ? total.rounds / seconds : 0.0) << endl;
+    return 0;
+}
+
+} // namespace blackjack